@@ -183,7 +183,9 @@ void setEventFwUpgradeEvent(bool success);
 void sendEventLogSent(void);
 
 /** /// @private
- * @brief Sends a CoAP POST Block 1 request to the server
+ * @brief Sends a CoAP POST Block 1 request to the server.
+ * The block-wise context is kept by the library: it starts with the first chunk and
+ * is reset when the file is done or the chunk retries (setFileUlRetries()) run out.
  *
  * @param filename The name of the file to send
  * @param data_chunk The data to send
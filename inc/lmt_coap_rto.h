@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_COAP_RTO_H
+#define LMT_COAP_RTO_H
+
+#include "lmt_som_event_emitter.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief RTT estimator state and counters
+ */
+typedef struct
+{
+    uint32_t samples;     // RTT samples taken
+    uint32_t ambiguous;   // Acknowledged exchanges not sampled after a timeout (Karn)
+    uint32_t timeouts;    // EVENT_COAP_NOACK, each backs the RTO off
+    uint32_t srtt_ms;     // Smoothed RTT, 0 before the first sample
+    uint32_t rttvar_ms;   // RTT variation
+    uint32_t min_rtt_ms;
+    uint32_t max_rtt_ms;
+    uint32_t last_rtt_ms;
+    uint32_t rto_ms;      // Current retransmission timeout
+    uint8_t wait_s;       // Last value set with setResponseWaitTimeout()
+} CoapRtoStats;
+
+/*
+ * Adaptive CoAP retransmission timeout. The mailer waits setResponseWaitTimeout()
+ * seconds for the ACK of a confirmable message before it reports EVENT_COAP_NOACK and the
+ * uplink is resent on the setResendPacketInitialTimeout() schedule. A fixed wait is far
+ * too long on a good cell and too short on a poor NB-IoT cell, where the late ACK makes
+ * the resend spurious.
+ *
+ * coapRtoOnEvent() times each exchange from EVENT_COAP_START to EVENT_COAP_OK and keeps
+ * the smoothed RTT and its variation as in RFC 6298: SRTT and RTTVAR with gains of 1/8
+ * and 1/4, RTO = SRTT + max(1 s, 4 * RTTVAR). Like the CoCoA strong estimator only the
+ * exchanges of an uplink before its first timeout are sampled, as a later ACK cannot be
+ * matched to its transmission (Karn). Every timeout doubles the RTO. The RTO is bounded
+ * by CONFIG_LMTSDK_COAP_RTO_MIN_S and CONFIG_LMTSDK_COAP_RTO_MAX_S and applied with
+ * setResponseWaitTimeout() in whole seconds, only when that value changes. Until the
+ * first sample the configured wait is kept.
+ *
+ * The library talks to one server, so there is one estimator. coapRtoOnEvent() must be
+ * called for the CoAP and uplink events, or is subscribed to them with
+ * CONFIG_LMTSDK_EVENT_SUBSCRIBE.
+ */
+
+/**
+ * @brief Copies the estimator state and counters
+ *
+ * @param p_stats pointer to the output stats
+ * @return 0 on success, -EINVAL on invalid parameters
+ */
+int coapRtoGetStats(CoapRtoStats *p_stats);
+
+/**
+ * @brief Clears the estimator and the counters, the RTO returns to the wait that was
+ * configured before the first sample
+ */
+void coapRtoReset(void);
+
+/**
+ * @brief Prints the estimator state in one line:
+ * "rtt n=<count> srtt=<ms> rttvar=<ms> min=<ms> max=<ms> rto=<ms> wait=<s> timeouts=<count>
+ * ambiguous=<count>"
+ *
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the text, cut to the buffer, -EINVAL on invalid parameters
+ */
+int coapRtoFormat(char *p_out, size_t size);
+
+/**
+ * @brief Samples the RTT from EVENT_COAP_START to EVENT_COAP_OK and backs the RTO off on
+ * EVENT_COAP_NOACK. EVENT_UL_START, EVENT_UL_DONE and EVENT_UL_MAX_RETRY delimit the
+ * uplinks for the ambiguous samples. Other events are ignored.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer (unused)
+ * @param i_data Event integer data (unused)
+ */
+void coapRtoOnEvent(SomEvent event, void *p_data, int i_data);
+
+#endif // LMT_COAP_RTO_H
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_ENERGY_H
+#define LMT_ENERGY_H
+
+#include "lmt_som_event_emitter.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Modem current while RRC connected, the radio is on
+#define ENERGY_CONNECTED_CURRENT_UA CONFIG_LMTSDK_ENERGY_CONNECTED_CURRENT_UA
+// Modem current while on and RRC idle, e.g. paging and the PSM active time
+#define ENERGY_IDLE_CURRENT_UA      CONFIG_LMTSDK_ENERGY_IDLE_CURRENT_UA
+
+/**
+ * @brief Time in the modem states and the exchanges of one uplink or of all time since
+ * energyReset(). The times are in milliseconds and wrap after 49 days.
+ */
+typedef struct
+{
+    uint32_t uplinks;      // EVENT_UL_START count
+    uint32_t failed;       // Uplinks ended by EVENT_UL_MAX_RETRY
+    uint32_t retries;      // EVENT_UL_RETRY count
+    uint32_t packets;      // EVENT_COAP_START count, every retry is a packet
+    uint32_t acked;        // EVENT_COAP_OK count
+    uint32_t measurements; // Counted by energyAddMeasurements()
+    uint32_t modem_on_ms;  // Between EVENT_MODEM_ON and EVENT_MODEM_OFF
+    uint32_t connected_ms; // Between EVENT_RRC_CONNECTED and EVENT_RRC_IDLE
+    uint32_t coap_ms;      // From EVENT_COAP_START to the ACK, NOACK or failure
+    uint64_t charge_uc;    // Estimated modem charge in microcoulombs (uA * s)
+} EnergyLedger;
+
+/*
+ * Energy and airtime ledger of the modem. The library reports the modem power, the RRC
+ * state and the CoAP exchanges as events, energyOnEvent() integrates the time between
+ * them, called from an application handleSomEvent() override or, with
+ * CONFIG_LMTSDK_EVENT_SUBSCRIBE, as a subscriber of those events. The time of an uplink,
+ * EVENT_UL_START to EVENT_UL_DONE or EVENT_UL_MAX_RETRY, is also kept on its own, with
+ * its packets and retries. The RRC inactivity time after EVENT_UL_DONE, until the
+ * network releases the connection, counts in the totals only.
+ *
+ * The charge is an estimate: the connected time at ENERGY_CONNECTED_CURRENT_UA plus the
+ * rest of the modem on time at ENERGY_IDLE_CURRENT_UA. The connected milliseconds per
+ * packet or per measurement are the figures to compare when tuning setUplinkTimeout(),
+ * the PSM timers and the uplink batching.
+ *
+ * The library encodes the Uplink.Connection block of A2.proto itself, with a fixed
+ * schema, so the ledger is uploaded as a Tape column with energyAddColumn() instead.
+ */
+
+/**
+ * @brief Counts measurements for the radio on time per measurement, e.g. one per Tape
+ * column
+ *
+ * @param count the number of new measurements
+ */
+void energyAddMeasurements(uint32_t count);
+
+/**
+ * @brief Copies the ledger of the last finished uplink
+ *
+ * @param p_ledger pointer to the output ledger
+ * @return 0 on success, -EINVAL if p_ledger is NULL, -ENODATA if no uplink has finished
+ */
+int energyGetLast(EnergyLedger *p_ledger);
+
+/**
+ * @brief Copies the ledger of all time since energyReset() or the boot, the open states
+ * counted up to now
+ *
+ * @param p_ledger pointer to the output ledger
+ * @return 0 on success, -EINVAL if p_ledger is NULL
+ */
+int energyGetTotals(EnergyLedger *p_ledger);
+
+/**
+ * @brief Clears the totals and the last uplink, the modem and RRC states are kept
+ */
+void energyReset(void);
+
+/**
+ * @brief Prints the totals and the last uplink, one line each:
+ * "<total|last> ul=<uplinks> fail= retry= pkt= ack= on=<ms> conn=<ms> coap=<ms>
+ * mC=<charge> conn/pkt=<ms> conn/meas=<ms>", 0 per packet or measurement when none
+ *
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the text cut to the buffer, -EINVAL on invalid parameters
+ */
+int energyFormat(char *p_out, size_t size);
+
+/**
+ * @brief Adds the last uplink as a column to the given Tape (lmt_tape_packer.h), with the
+ * Tracks modem on, connected and CoAP milliseconds, packets, retries, failed uplink (0 or
+ * 1) and the charge in millicoulombs.
+ *
+ * @param i_tape the Tape index
+ * @param period the period of the column
+ * @return number of remaining empty columns, -ENODATA if no uplink has finished,
+ * -ENOTSUP without CONFIG_LMTSDK_TAPE_PACKER, negative error code of tapeAddColumn() on fail
+ */
+int energyAddColumn(uint8_t i_tape, uint32_t period);
+
+/**
+ * @brief Integrates the time since the last event into the ledgers and follows the
+ * EVENT_MODEM_ON/OFF, EVENT_RRC_CONNECTED/IDLE, EVENT_COAP_* and EVENT_UL_* events.
+ * Other events are ignored.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer (unused)
+ * @param i_data Event integer data (unused)
+ */
+void energyOnEvent(SomEvent event, void *p_data, int i_data);
+
+#endif // LMT_ENERGY_H
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_EVENT_QUEUE_H
+#define LMT_EVENT_QUEUE_H
+
+#include "lmt_som_event_emitter.h"
+#include <stdint.h>
+
+// Events waiting for the dispatch thread
+#define EVENT_QUEUE_LENGTH    CONFIG_LMTSDK_EVENT_QUEUE_LENGTH
+// Event data copied with a queued event, i_data is its length
+#define EVENT_QUEUE_DATA_SIZE CONFIG_LMTSDK_EVENT_QUEUE_DATA_SIZE
+
+/**
+ * @brief How eventQueuePost() delivers an event
+ */
+typedef enum
+{
+    EVENT_DISPATCH_QUEUED,    /**< Queued in order, delivered by the dispatch thread. */
+    EVENT_DISPATCH_COALESCED, /**< Queued, merged into the newest pending record if it is
+                                   the same event. */
+    EVENT_DISPATCH_DIRECT,    /**< Delivered at once in the emitting thread. */
+} EventDispatch;
+
+/**
+ * @brief Dispatch counters since the boot
+ */
+typedef struct
+{
+    uint32_t posted;         // eventQueuePost() calls
+    uint32_t queued;         // Delivered by the dispatch thread
+    uint32_t direct;         // Delivered in the emitting thread, overflows included
+    uint32_t coalesced;      // Merged into the newest pending record
+    uint32_t overflows;      // Delivered directly because the queue was full or the data large
+    uint32_t superseded;     // Pending records dropped for a direct event of the opposite state
+    uint32_t depth;          // Records pending now
+    uint32_t max_depth;      // Most records pending at once
+    uint32_t max_latency_us; // Longest time from the post to the delivery
+    uint64_t total_latency_us;
+} EventQueueStats;
+
+/*
+ * Asynchronous delivery of the library events. The library calls handleSomEvent() in
+ * the thread that raised the event and its default handler calls the on<EventName>()
+ * callbacks there, so a slow callback, e.g. onTerminalCmd(), stalls the mailer.
+ * With this module the application handleSomEvent() override passes the events to
+ * eventQueuePost(), which queues them for a dedicated work queue thread
+ * (CONFIG_LMTSDK_EVENT_QUEUE_PRIORITY) that calls the same on<EventName>() callbacks:
+ *
+ *     void handleSomEvent(SomEvent event, void *p_data, int i_data)
+ *     {
+ *         uplinkQueueOnEvent(event, p_data, i_data);
+ *         eventQueuePost(event, p_data, i_data);
+ *     }
+ *
+ * The event data may not outlive the handleSomEvent() call. Of EVENT_TERMINAL_CMD, whose
+ * p_data points to i_data bytes, a queued event carries a copy and the callback gets a
+ * pointer to the copy. Other events with p_data are delivered directly in the emitting
+ * thread, as the size of their data is unknown. Events with data larger than
+ * EVENT_QUEUE_DATA_SIZE or that find the queue full are delivered directly as well and
+ * counted as overflows.
+ *
+ * Every event is queued by default, in the order of the posts, and EVENT_UL_RETRY is
+ * coalesced. eventQueueSetDispatch() changes the mode of any event. A directly delivered
+ * event gives up the ordering: it runs ahead of the pending records, after the callback
+ * in progress returns. So that it does not leave a stale state behind, the pending
+ * records of its opposite state event (EVENT_NETWORK_UP and EVENT_NETWORK_DOWN,
+ * EVENT_RRC_IDLE and EVENT_RRC_CONNECTED, EVENT_MODEM_ON and EVENT_MODEM_OFF) are
+ * dropped and counted as superseded.
+ *
+ * With CONFIG_LMTSDK_EVENT_SUBSCRIBE somEventPublish() posts the events here after
+ * calling the subscribers, the override then only calls somEventPublish().
+ */
+
+/**
+ * @brief Sets how an event is delivered
+ *
+ * @param event The event type
+ * @param dispatch the delivery mode
+ * @return 0 on success, -EINVAL if event or dispatch is out of range
+ */
+int eventQueueSetDispatch(SomEvent event, EventDispatch dispatch);
+
+/**
+ * @brief Delivers an event to its on<EventName>() callback by its dispatch mode.
+ * Safe to call from any thread.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer, copied for a queued event
+ * @param i_data Event integer data, the length of p_data of EVENT_TERMINAL_CMD
+ */
+void eventQueuePost(SomEvent event, void *p_data, int i_data);
+
+/**
+ * @brief Copies the dispatch counters
+ *
+ * @param p_stats pointer to the output counters
+ * @return 0 on success, -EINVAL if p_stats is NULL
+ */
+int eventQueueGetStats(EventQueueStats *p_stats);
+
+#endif // LMT_EVENT_QUEUE_H
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_EVENT_SUBSCRIBE_H
+#define LMT_EVENT_SUBSCRIBE_H
+
+#include "lmt_som_event_emitter.h"
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @brief Subscriber callback, gets the event type too so one function can take several
+ */
+typedef void (*SomEventCallback)(SomEvent event, void *p_data, int i_data);
+
+/**
+ * @brief Entry of the subscriber section, use SOM_EVENT_SUBSCRIBE()
+ */
+typedef struct SomEventSubscriber
+{
+    SomEvent event; // EVENT_COUNT for every event
+    SomEventCallback callback;
+} SomEventSubscriber;
+
+/*
+ * Event subscribers collected at link time. SOM_EVENT_SUBSCRIBE() places a const entry
+ * in a flash section that the linker sorts by the event name, so the subscribers of an
+ * event are adjacent and somEventPublish() calls exactly them, without a lookup or a
+ * wrapper handler. The application and any module can subscribe to the same event.
+ *
+ * somEventPublish() calls the subscribers of the event, the subscribers of every event,
+ * then the on<EventName>() callback of the application: from the const table of
+ * somEventCallHandler(), or through eventQueuePost() with CONFIG_LMTSDK_EVENT_QUEUE. The
+ * application handleSomEvent() override only has to publish:
+ *
+ *     void handleSomEvent(SomEvent event, void *p_data, int i_data)
+ *     {
+ *         somEventPublish(event, p_data, i_data);
+ *     }
+ *
+ * The SDK modules with an event helper (uplinkQueueOnEvent(), latencyOnEvent(),
+ * energyOnEvent(), uplinkSchedulerOnEvent(), coapRtoOnEvent()) subscribe it themselves
+ * then, so do not forward events to them.
+ */
+
+/**
+ * @brief Subscribes a callback to an event at link time
+ *
+ * @param event the event, a SomEvent name (e.g. EVENT_COAP_OK), not an expression
+ * @param callback the SomEventCallback
+ */
+#define SOM_EVENT_SUBSCRIBE(_event, _callback)                                                 \
+    static const STRUCT_SECTION_ITERABLE(SomEventSubscriber,                                   \
+                                         SOM_EVENT_SUBSCRIBER_NAME(_event, _callback)) = {     \
+        .event = _event, .callback = _callback}
+
+// The section is sorted by this name, so the subscribers of an event are adjacent
+#define SOM_EVENT_SUBSCRIBER_NAME(_event, _callback)                                           \
+    _CONCAT(som_event_sub_, _CONCAT(_event, _CONCAT(__, _callback)))
+
+/**
+ * @brief Subscribes a callback to every event at link time
+ *
+ * @param callback the SomEventCallback
+ */
+#define SOM_EVENT_SUBSCRIBE_ALL(_callback) SOM_EVENT_SUBSCRIBE(EVENT_COUNT, _callback)
+
+/**
+ * @brief Calls the subscribers of the event and the on<EventName>() callback
+ *
+ * @param event The event type
+ * @param p_data Event data pointer
+ * @param i_data Event integer data
+ */
+void somEventPublish(SomEvent event, void *p_data, int i_data);
+
+/**
+ * @brief Calls the on<EventName>() callback of the event from a const table, if the
+ * application or the library links one. Built with CONFIG_LMTSDK_EVENT_SUBSCRIBE or
+ * CONFIG_LMTSDK_EVENT_QUEUE.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer
+ * @param i_data Event integer data
+ */
+void somEventCallHandler(SomEvent event, void *p_data, int i_data);
+
+#endif // LMT_EVENT_SUBSCRIBE_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_HOST_SHIM_H
+#define LMT_HOST_SHIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Host build of the open source modules (CONFIG_LMTSDK_HOST), for native_sim. The
+ * prebuilt library is not linked, this shim implements the part of its API the modules
+ * call:
+ *  - fileRead(), fileOverwrite(), getFileSize() and deleteFile() on the LittleFS volume of
+ *    the lfs1 fstab node, only with CONFIG_LMTSDK_HOST_FS, which the modules that keep
+ *    files select. The lmtsdk-host-fs snippet provides the node on the flash simulator
+ *  - setRawData() keeps the raw data for hostShimPack(), there is no mailer or modem
+ *  - sendFileChunk() counts the bytes, see hostShimGetSentBytes()
+ *  - triggerMailer() counts the triggers, see hostShimGetMailerTriggers(), and the mailer
+ *    wait mode is only kept
+ *  - getNetworkQuality() returns the quality set with hostShimSetNetworkQuality()
+ *  - the settings getters return fixed values (HOST_SHIM_* in lmt_host_shim.c), raw data
+ *    mode included
+ *  - handleSomEvent() is weak and ignores the events, like the library default handler
+ *  - date_time_now() counts from a fixed time without CONFIG_DATE_TIME
+ *
+ * The library code itself (protobuf handler, CoAP queue, mailer, GNSS) is not open and
+ * does not build for the host.
+ */
+
+/**
+ * @brief Takes the raw data handed over with setRawData() the way the mailer would:
+ * emits EVENT_PACKER_STARTED and EVENT_PACKER_DONE_OK through handleSomEvent()
+ *
+ * @return length of the raw data taken, -ENODATA if none was handed over
+ */
+int hostShimPack(void);
+
+/**
+ * @brief Returns the bytes sent with sendFileChunk() since the boot
+ *
+ * @return byte count
+ */
+size_t hostShimGetSentBytes(void);
+
+/**
+ * @brief Returns the triggerMailer() calls since the boot
+ *
+ * @return trigger count
+ */
+uint32_t hostShimGetMailerTriggers(void);
+
+/**
+ * @brief Sets the quality getNetworkQuality() returns, which fails until the first call
+ *
+ * @param rsrp RSRP in dBm
+ * @param rsrq RSRQ in dB
+ * @param snr SNR in dB
+ */
+void hostShimSetNetworkQuality(int32_t rsrp, int32_t rsrq, int32_t snr);
+
+#endif // LMT_HOST_SHIM_H
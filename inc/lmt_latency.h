@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_LATENCY_H
+#define LMT_LATENCY_H
+
+#include "lmt_som_event_emitter.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Bucket i counts durations below 2^i us, the last bucket everything longer
+#define LATENCY_BUCKET_COUNT 22
+
+/**
+ * @brief Measured paths
+ */
+typedef enum
+{
+    LATENCY_TAPE_ENCODE,     /**< tapeSubmit() encoding the Tapes into the queue record. */
+    LATENCY_UPLINK_COMPRESS, /**< uplinkCompress() of one raw uplink. */
+    LATENCY_QUEUE_HANDOVER,  /**< setRawData() call of the uplink queue. */
+    LATENCY_SPILL_WRITE,     /**< Journal append and sync of the uplink spill. */
+    LATENCY_LOG_STORE_WRITE, /**< Flash write of a log store page. */
+    LATENCY_PACKER,          /**< EVENT_PACKER_STARTED to the packer result event. */
+    LATENCY_COAP,            /**< EVENT_COAP_START to the ACK, NOACK or failure event. */
+    LATENCY_UPLINK,          /**< EVENT_UL_START to EVENT_UL_DONE or EVENT_UL_MAX_RETRY. */
+    LATENCY_PROBE_COUNT      /**< Probe count. */
+} LatencyProbe;
+
+/**
+ * @brief Fixed bucket histogram of one probe
+ */
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[LATENCY_BUCKET_COUNT];
+} LatencyHistogram;
+
+/*
+ * Latency histograms of the SDK hot paths. The code paths are timed with the
+ * cycle counter of the Zephyr timing API (DWT on the nRF91 Cortex-M33), the library
+ * threads, whose code is not open, from their events: latencyOnEvent() must be called
+ * for the packer, CoAP and uplink events, e.g. from an application handleSomEvent()
+ * override, or is subscribed to them with CONFIG_LMTSDK_EVENT_SUBSCRIBE. The packer
+ * span is what PACKER_LOOP_TIME of lmt_coap_manager.h allows for.
+ *
+ * The histograms can be printed with latencyFormat(), e.g. as the answer of a terminal
+ * command, or uploaded as a diagnostic Tape with latencyAddColumns().
+ */
+
+#if defined(CONFIG_LMTSDK_LATENCY)
+#include <zephyr/timing/timing.h>
+
+// Starts timing a path, the start is kept in a local variable of the given name
+#define LATENCY_START(name)       timing_t name = timing_counter_get()
+// Records the time since LATENCY_START(name) for the probe
+#define LATENCY_STOP(probe, name) latencyStop(probe, name)
+
+/**
+ * @brief Records the time since start for the probe, use LATENCY_STOP()
+ *
+ * @param probe the measured path
+ * @param start the cycle counter at the start
+ */
+void latencyStop(LatencyProbe probe, timing_t start);
+#else
+#define LATENCY_START(name)
+#define LATENCY_STOP(probe, name)
+#endif
+
+/**
+ * @brief Records a duration for the probe
+ *
+ * @param probe the measured path
+ * @param us the duration in microseconds
+ */
+void latencyRecord(LatencyProbe probe, uint32_t us);
+
+/**
+ * @brief Copies the histogram of a probe
+ *
+ * @param probe the measured path
+ * @param p_histogram pointer to the output histogram
+ * @return 0 on success, -EINVAL on invalid parameters
+ */
+int latencyGet(LatencyProbe probe, LatencyHistogram *p_histogram);
+
+/**
+ * @brief Returns the upper bound of the bucket that holds the given percentile
+ *
+ * @param p_histogram pointer to the histogram
+ * @param percent the percentile, 1 to 100
+ * @return duration in microseconds, 0 if the histogram is empty
+ */
+uint32_t latencyPercentile(const LatencyHistogram *p_histogram, uint8_t percent);
+
+/**
+ * @brief Clears all histograms
+ */
+void latencyReset(void);
+
+/**
+ * @brief Prints the probes with samples, one line each:
+ * "<probe> n=<count> avg=<us> p50<=<us> p99<=<us> max=<us>"
+ *
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the text, cut to the buffer
+ */
+int latencyFormat(char *p_out, size_t size);
+
+/**
+ * @brief Adds one column per probe with samples to the given Tape (lmt_tape_packer.h),
+ * with the Tracks probe, count, average, p50, p90, p99 and max in microseconds.
+ * The period is the seconds since the last latencyReset() at the first call on the empty
+ * Tape; later calls reuse it until tapeSubmit() empties the Tape, so any number of calls
+ * per upload take one period entry. Use a Tape of its own for the latency columns.
+ *
+ * @param i_tape the Tape index
+ * @return number of columns added, -ENOTSUP without CONFIG_LMTSDK_TAPE_PACKER,
+ * -EINVAL if i_tape is out of range, negative error code of tapeAddColumn() on fail
+ */
+int latencyAddColumns(uint8_t i_tape);
+
+/**
+ * @brief Times the library threads from their events: EVENT_PACKER_STARTED,
+ * EVENT_COAP_START and EVENT_UL_START start a span that their result events end.
+ * Other events are ignored.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer (unused)
+ * @param i_data Event integer data (unused)
+ */
+void latencyOnEvent(SomEvent event, void *p_data, int i_data);
+
+#endif // LMT_LATENCY_H
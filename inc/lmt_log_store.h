@@ -0,0 +1,224 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_LOG_STORE_H
+#define LMT_LOG_STORE_H
+
+#include "lmt_settings.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Text collected before it is compressed and written as one block
+#define LOG_STORE_BLOCK_SIZE        CONFIG_LMTSDK_LOG_STORE_BLOCK_SIZE
+// Records waiting for the store thread
+#define LOG_STORE_QUEUE_LENGTH      CONFIG_LMTSDK_LOG_STORE_QUEUE_LENGTH
+// Largest log line or dictionary record, longer ones are cut
+#define LOG_STORE_RECORD_SIZE       CONFIG_LMTSDK_LOG_STORE_RECORD_SIZE
+// Compressed blocks are written to flash in pages of the SPI NOR layout
+#define LOG_STORE_PAGE_SIZE         CONFIG_SPI_NOR_FLASH_LAYOUT_PAGE_SIZE
+// Longest time a taken line waits in RAM, 0 for no timer
+#define LOG_STORE_FLUSH_INTERVAL_MS CONFIG_LMTSDK_LOG_STORE_FLUSH_INTERVAL_MS
+// Bytes handed to sendFileChunk() at a time
+#define LOG_STORE_UPLOAD_CHUNK_SIZE 512
+#if defined(CONFIG_LMTSDK_LOG_STORE_PARTITION)
+// Erase, rotation and upload unit of the partition
+#define LOG_STORE_SEGMENT_SIZE      CONFIG_LMTSDK_LOG_STORE_SEGMENT_SIZE
+#endif
+
+#define LOG_STORE_BLOCK_MAGIC            0x424C // "LB", text lines
+#define LOG_STORE_DICTIONARY_BLOCK_MAGIC 0x444C // "LD", LogStoreRecordHead records
+#define LOG_STORE_SEGMENT_MAGIC          0x4745534C // "LSEG"
+#define LOG_STORE_SEGMENT_NOT_UPLOADED   0xFFFFFFFF
+
+/**
+ * @brief Head of every block in a log store file, little endian.
+ * The payload follows the head: an LZ4 block (lmt_uplink_compress.h, no dictionary)
+ * of raw_len bytes of log lines or records, or the bytes themselves when len equals raw_len.
+ * The levels and the timestamps index the block, a reader skips it without the payload.
+ */
+typedef struct
+{
+    uint16_t magic;   // LOG_STORE_BLOCK_MAGIC or LOG_STORE_DICTIONARY_BLOCK_MAGIC
+    uint16_t raw_len; // Text length of the block
+    uint16_t len;     // Payload length
+    uint16_t records; // Log lines in the block
+    uint32_t crc;     // CRC32 (IEEE) of the payload
+    uint8_t levels;   // Bit per LogLevel of the lines
+    uint8_t reserved[3];
+    int64_t first; // Timestamp of the first line
+    int64_t last;  // Timestamp of the last line
+} LogStoreBlockHead;
+
+/**
+ * @brief Head of every record in a dictionary block (CONFIG_LMTSDK_LOG_STORE_DICTIONARY).
+ * The packed arguments follow the head in the order of the format conversions:
+ * 8 bytes for ll/j integers and floating point values, the characters and the
+ * terminating zero for strings, 4 bytes for everything else.
+ */
+typedef struct __attribute__((__packed__))
+{
+    uint8_t level;     // LogLevel
+    uint16_t len;      // Length of the packed arguments
+    int64_t timestamp; // Unix time in milliseconds, uptime before the time is known
+    int32_t format;    // Offset of the format string from log_store_format_base
+} LogStoreRecordHead;
+
+// Symbol the format offsets of LogStoreRecordHead count from
+extern const char log_store_format_base[];
+
+/**
+ * @brief Head of every segment of the log store partition (CONFIG_LMTSDK_LOG_STORE_PARTITION),
+ * little endian. The blocks follow the head up to the first erased (0xFFFF) magic.
+ */
+typedef struct
+{
+    uint32_t magic;    // LOG_STORE_SEGMENT_MAGIC
+    uint32_t seq;      // Sequence number, the segment index is seq modulo the segment count
+    uint32_t crc;      // CRC32 (IEEE) of magic and seq
+    uint32_t uploaded; // LOG_STORE_SEGMENT_NOT_UPLOADED, programmed to 0 once uploaded
+} LogStoreSegmentHead;
+
+/**
+ * @brief Selection of logStoreUploadRange(), logStoreParseFilter() fills it from text
+ */
+typedef struct
+{
+    int64_t from;     // Oldest timestamp sent, unix ms
+    int64_t to;       // Newest timestamp sent, unix ms
+    LogLevel level;   // Least severe level sent
+    size_t max_bytes; // Upload budget, block heads included
+} LogStoreFilter;
+
+/*
+ * Compressed log store, written next to the library app_*.log files in
+ * /lfs/log_<sequence>.lz4. Log lines are collected in RAM and written as
+ * self-contained LZ4 blocks, so a reader decodes a file block by block as it
+ * arrives (scripts/log_store_decode.py) and a torn tail costs one block only.
+ * Files rotate by the compressed size at getLogFileMaxSize() and the oldest files
+ * are deleted beyond getNumOfLogFiles(), so the same settings hold more history than
+ * the text logs by the compression ratio of the lines. Every boot starts a new file.
+ *
+ * The oldest, the first not uploaded and the current file are kept in a small
+ * catalogue file (/lfs/logstore.cat, rewritten on every rotation), so neither the
+ * boot nor the rotation lists the directory. Only a missing or damaged catalogue is
+ * rebuilt from the directory, all files count as not uploaded then. logStoreUpload()
+ * sends the files from the first not uploaded one with the file upload of the library.
+ *
+ * With CONFIG_LMTSDK_LOG_STORE_PARTITION the blocks go to a raw circular store on the
+ * log_store_partition flash partition instead of LittleFS: the partition is split into
+ * LOG_STORE_SEGMENT_SIZE segments written in turn, the next segment is erased when the
+ * current one is full, overwriting the oldest. Appends are plain flash programs with no
+ * file system metadata, and the segment heads replace the directory and the catalogue.
+ * The partition has to be on a flash that programs single bytes (SPI NOR), and
+ * getLogFileMaxSize() and getNumOfLogFiles() do not apply. Segments are uploaded as
+ * log_<sequence>.lz4 files of their blocks, so the decoder is the same.
+ *
+ * The library handles the LOG_REQUEST downlink itself and uploads whole text logs. For
+ * ranged requests pass the filter text in a COMMAND downlink, e.g. from onTerminalCmd(),
+ * to logStoreParseFilter() and logStoreUploadRange().
+ *
+ * Compressed blocks are collected in a page buffer and the file is appended one
+ * LOG_STORE_PAGE_SIZE page at a time, so LittleFS commits once per page instead of
+ * once per line. The page is written early by logStoreFlush(), by the flush timer
+ * (LOG_STORE_FLUSH_INTERVAL_MS after the first pending line) and, with
+ * CONFIG_LMTSDK_LOG_STORE_FLUSH_ON_ERROR, by every LOG_ERRORS line.
+ *
+ * The log calls never wait for flash or for each other: a call formats its line into a
+ * slot of a lock-free multi-producer queue (LOG_STORE_QUEUE_LENGTH slots), and a low
+ * priority store thread moves the lines into the block and writes it. The timestamp is
+ * taken by the call. When the queue is full the line is dropped and counted, read the
+ * count with logStoreGetDropped().
+ *
+ * With CONFIG_LMTSDK_LOG_STORE_DICTIONARY the lines are not formatted on the device:
+ * a record keeps the offset of the format string and the raw arguments, and
+ * scripts/log_store_decode.py --elf zephyr.elf expands them from the firmware image.
+ * Format strings have to be string literals of the same build then.
+ */
+
+/**
+ * @brief Queues a log line ("<unix ms> <E|W|I> <text>") if the level passes
+ * getLogLevel(). Does not block, safe to call from any thread.
+ *
+ * @param level the level of the line
+ * @param text the log text
+ * @return 0 on success, -EINVAL if text is NULL, -ENOBUFS if the queue is full
+ * (the line is dropped and counted)
+ */
+int logStoreWrite(LogLevel level, const char *text);
+
+/**
+ * @brief Variadic version of logStoreWrite(). With CONFIG_LMTSDK_LOG_STORE_DICTIONARY
+ * only the arguments are packed, format has to be a string literal then.
+ *
+ * @param level the level of the line
+ * @param format printf style format string
+ * @return 0 on success, -EINVAL if format is NULL, -ENOBUFS if the queue is full,
+ * -EMSGSIZE if the record head does not fit LOG_STORE_RECORD_SIZE
+ */
+int logStoreWriteFormatted(LogLevel level, const char *format, ...);
+
+/**
+ * @brief Compresses and writes the queued and collected log lines to flash and syncs the
+ * file, e.g. before a critical operation or a reboot. Blocks until the lines are written.
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+int logStoreFlush(void);
+
+/**
+ * @brief Returns the count of log lines dropped on a full queue since boot, e.g. for a
+ * diagnostic uplink. The count wraps at 2^32.
+ *
+ * @return the dropped line count
+ */
+uint32_t logStoreGetDropped(void);
+
+/**
+ * @brief Closes the current file and uploads the log store files not uploaded yet, oldest
+ * first, with sendFileChunk(). Sent files are marked in the catalogue and stay on flash
+ * until the rotation deletes them. Blocks until the upload is done, so call it from an
+ * application thread.
+ *
+ * @return 0 on success, negative error code of sendFileChunk() or the file system on fail
+ */
+int logStoreUpload(void);
+
+/**
+ * @brief Parses a filter of space separated keys, e.g. "from=1760000000000 level=E max=4096":
+ * from and to in unix ms, level as E, W, I or the LogLevel value, max in bytes. Missing keys
+ * select everything.
+ *
+ * @param p_text the filter text, e.g. from a COMMAND downlink
+ * @param p_filter pointer to the filter
+ * @return 0 on success, -EINVAL on an unknown key or a bad value
+ */
+int logStoreParseFilter(const char *p_text, LogStoreFilter *p_filter);
+
+/**
+ * @brief Uploads only the log lines that match the filter with sendFileChunk(), as
+ * log_range.lz4 in the log store format. The newest matching lines that fit max_bytes are
+ * sent, oldest first. Blocks out of the time range or without a matching level are
+ * skipped by their heads, without reading them. The upload is collected in the scratch
+ * file /lfs/logstore.rng first, the log store files are left as they are. Blocks until the
+ * upload is done, so call it from an application thread.
+ *
+ * @param p_filter the filter
+ * @return 0 on success, -EINVAL if p_filter is NULL, -ENODATA if no line matches,
+ * negative error code of sendFileChunk() or the file system on fail
+ */
+int logStoreUploadRange(const LogStoreFilter *p_filter);
+
+#endif // LMT_LOG_STORE_H
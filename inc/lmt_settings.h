@@ -240,6 +240,8 @@ int setResponseWaitTimeout(uint8_t timeout);
 
 /**
  * @brief Set the number of retries for file uploads.
+ * The retries apply to every Block1 chunk. Once they are used up the block-wise
+ * transfer is reset and the next upload of the file starts from its first block.
  *
  * @param retries Number of retries for file uploads.
  * 1 <= retries <= 10.
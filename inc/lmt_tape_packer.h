@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_TAPE_PACKER_H
+#define LMT_TAPE_PACKER_H
+
+#include "lmt_coap_manager.h"
+#include "lmt_proto_handler.h"
+#include "lmt_uplink_queue.h"
+#include "proto/A2Tape.pb.h"
+#include <stddef.h>
+
+// Number of Tapes in use, at most the TapeUplink.Tape max_count of A2Tape.options (4)
+#define TAPE_COUNT             CONFIG_LMTSDK_TAPE_COUNT
+// Column capacity shared by all Tapes
+#define TAPE_MAX_COLUMNS_COUNT CONFIG_LMTSDK_TAPE_MAX_COLUMNS
+// Uplink payload budget, the largest uplink queue record
+#define TAPE_PAYLOAD_MAX_SIZE UPLINK_QUEUE_MAX_LEN
+
+/**
+ * @brief Sets the Track encoding of the given Tape. The Tape is rewound
+ * when the encoding changes.
+ *
+ * TAPE_ABSOLUTE sends every Track as is (same as the A2 Column).
+ * TAPE_DELTA_ZIGZAG sends every Track as the zigzag delta against the same Track
+ * of the previous column; the first column of an uplink is sent against zero.
+ *
+ * @param i_tape the Tape index
+ * @param encoding the Track encoding
+ * @return 0 on success, -EINVAL if i_tape or encoding is out of range
+ */
+int tapeSetEncoding(uint8_t i_tape, TapeEncoding encoding);
+
+/**
+ * @brief Returns the Track encoding of the given Tape
+ *
+ * @param i_tape the Tape index
+ * @return the Track encoding, TAPE_ABSOLUTE if i_tape is out of range
+ */
+TapeEncoding tapeGetEncoding(uint8_t i_tape);
+
+/**
+ * @brief Sets the Tracks sent in the columns of the given Tape. Tracks outside the mask
+ * cost zero bytes; the columns still take MAX_TRACKS_COUNT measurements.
+ * The Tape is rewound when the mask changes.
+ *
+ * @param i_tape the Tape index
+ * @param mask bitmap of the Tracks in use, e.g. BIT_MASK(4) for Tracks 0..3;
+ * 0 for all MAX_TRACKS_COUNT Tracks (default)
+ * @return 0 on success, -EINVAL if i_tape or mask is out of range
+ */
+int tapeSetTrackMask(uint8_t i_tape, uint32_t mask);
+
+/**
+ * @brief Sets the column count that makes the given Tape full. Lets a fast Tape
+ * trigger the uplink on its own while slow Tapes ride along in the same TapeUplink.
+ *
+ * @param i_tape the Tape index
+ * @param limit the column count, 0 for no limit besides the uplink size
+ * @return 0 on success, -EINVAL if i_tape or limit is out of range
+ */
+int tapeSetColumnLimit(uint8_t i_tape, pb_size_t limit);
+
+/**
+ * @brief Adds a new period to the Periods array of the given Tape.
+ * Same rules as updatePeriod(): duplicate values are not added and
+ * the entries without measurements are overwritten.
+ *
+ * @param i_tape the Tape index
+ * @param value the period value
+ * @return 0 on success, -EINVAL if i_tape is out of range,
+ * -ENOSPC if the Periods array is full
+ */
+int tapeUpdatePeriod(uint8_t i_tape, uint32_t value);
+
+/**
+ * @brief Adds a measurements column and its period to the given Tape.
+ * The column is accepted only if the encoded TapeUplink still fits
+ * TAPE_PAYLOAD_MAX_SIZE, so the Tapes fill by encoded size and not by column count.
+ *
+ * @param i_tape the Tape index
+ * @param period the period value
+ * @param p_measurements pointer to the measurements array in count of MAX_TRACKS_COUNT
+ * @return number of remaining empty columns estimated from the size of this column
+ * (0 means the uplink is full), -EINVAL if i_tape is out of range,
+ * -ENOSPC if the column does not fit and the Tapes have to be submitted first
+ */
+int tapeAddColumn(uint8_t i_tape, uint32_t period, const int32_t *p_measurements);
+
+/**
+ * @brief Returns actual column count in Tape
+ *
+ * @param i_tape the Tape index
+ * @return Column count in Tape
+ */
+pb_size_t tapeGetRecordsCount(uint8_t i_tape);
+
+/**
+ * @brief Resets the Tape keeping the last period entry. The other Tapes are kept.
+ *
+ * @param i_tape the Tape index
+ */
+void tapeRewind(uint8_t i_tape);
+
+/**
+ * @brief Returns the encoded TapeUplink size of the current Tapes.
+ * The size is accounted on every tapeAddColumn(), no encoding is done.
+ *
+ * @return Encoded size in bytes (Timestamp field counted at its worst case)
+ */
+size_t tapeGetEncodedSize(void);
+
+/**
+ * @brief Checks if the given Tape reached its column limit
+ *
+ * @param i_tape the Tape index
+ * @return true if full, false otherwise
+ */
+bool tapeIsFull(uint8_t i_tape);
+
+/**
+ * @brief Checks if the UDP packet is full, i.e. any Tape reached its column limit or
+ * the next column as large as the last added one would push the TapeUplink
+ * past TAPE_PAYLOAD_MAX_SIZE
+ *
+ * @return true if full, false otherwise
+ */
+bool tapeIsUdpPacketFull(void);
+
+/**
+ * @brief Encodes all Tapes with columns into one TapeUplink message.
+ * Every Tape keeps its own Periods and delta base.
+ *
+ * @param p_buffer pointer to the output buffer
+ * @param size size of the output buffer
+ * @param p_len pointer to store the encoded message length
+ * @return 0 on success, -EINVAL on invalid parameters, -ENOMEM if the buffer is too small
+ */
+int tapeEncode(uint8_t *p_buffer, size_t size, size_t *p_len);
+
+/**
+ * @brief Decodes a TapeUplink message back to absolute measurement columns.
+ * Counterpart of tapeEncode() for tools and self-tests.
+ *
+ * @param p_buffer pointer to the encoded message
+ * @param len length of the encoded message
+ * @param i_tape the Tape index to extract
+ * @param p_columns pointer to the output array of max_columns * MAX_TRACKS_COUNT values
+ * @param max_columns capacity of the output array in columns
+ * @return number of decoded columns, -EINVAL on invalid parameters,
+ * -EBADMSG if the message could not be decoded
+ */
+int tapeDecode(const uint8_t *p_buffer, size_t len, uint8_t i_tape, int32_t *p_columns,
+               size_t max_columns);
+
+/**
+ * @brief Encodes all Tapes with columns straight into an uplink queue record and
+ * hands it to the mailer (see lmt_uplink_queue.h). The Tapes are rewound once the
+ * message is queued. Requires raw data mode (setUlDataMode(1)).
+ *
+ * @param upload Flag to trigger mailer for immediate upload
+ * @return 0 on success, -ENODATA if all Tapes are empty, -ENOBUFS if the uplink queue
+ * is full (the Tapes are kept), negative error code of uplinkQueueSend() on fail
+ * (the message stays queued)
+ */
+int tapeSubmit(bool upload);
+
+#endif // LMT_TAPE_PACKER_H
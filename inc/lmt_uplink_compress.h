@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_UPLINK_COMPRESS_H
+#define LMT_UPLINK_COMPRESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest preset dictionary, matches reach back at most 64 KB in the LZ4 block format
+#define UPLINK_COMPRESS_MAX_DICT_SIZE 32768
+
+/*
+ * LZ4 block format compression of the raw uplinks, so the server can use any LZ4
+ * block decoder (LZ4_decompress_safe_usingDict() with the same dictionary).
+ * The uplink queue compresses every committed uplink and keeps the original when
+ * compression does not pay off; compressed uplinks are sent as the Compressed field
+ * of the batch message (see lmt_uplink_queue.h).
+ */
+
+/**
+ * @brief Sets the preset dictionary, e.g. a typical uplink, that the first matches
+ * can refer to. The dictionary is hashed here once, it is not copied and has to stay
+ * valid and unchanged. The server has to decode with the same dictionary.
+ *
+ * @param p_dict pointer to the dictionary, NULL for none
+ * @param len length of the dictionary
+ * @return 0 on success, -EINVAL if len is larger than UPLINK_COMPRESS_MAX_DICT_SIZE
+ */
+int uplinkCompressSetDictionary(const uint8_t *p_dict, size_t len);
+
+/**
+ * @brief Compresses the data into one LZ4 block
+ *
+ * @param p_in pointer to the data
+ * @param len length of the data
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the compressed data, -EINVAL on invalid parameters,
+ * -ENOMEM if the compressed data does not fit the output buffer
+ */
+int uplinkCompress(const uint8_t *p_in, size_t len, uint8_t *p_out, size_t size);
+
+/**
+ * @brief Compresses the data into one LZ4 block with the given dictionary instead of
+ * the uplink one, e.g. for the log store (lmt_log_store.h). The dictionary is hashed
+ * on every call.
+ *
+ * @param p_dict pointer to the dictionary, NULL for none
+ * @param dict_len length of the dictionary, at most UPLINK_COMPRESS_MAX_DICT_SIZE
+ * @param p_in pointer to the data
+ * @param len length of the data
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the compressed data, -EINVAL on invalid parameters,
+ * -ENOMEM if the compressed data does not fit the output buffer
+ */
+int uplinkCompressWithDictionary(const uint8_t *p_dict, size_t dict_len, const uint8_t *p_in,
+                                 size_t len, uint8_t *p_out, size_t size);
+
+/**
+ * @brief Decompresses one LZ4 block made with the current dictionary.
+ * Counterpart of uplinkCompress() for tools and self-tests.
+ *
+ * @param p_in pointer to the compressed data
+ * @param len length of the compressed data
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the decompressed data, -EINVAL on invalid parameters,
+ * -EBADMSG if the block is malformed or does not fit the output buffer
+ */
+int uplinkDecompress(const uint8_t *p_in, size_t len, uint8_t *p_out, size_t size);
+
+/**
+ * @brief Decompresses one LZ4 block made with the given dictionary
+ *
+ * @param p_dict pointer to the dictionary, NULL for none
+ * @param dict_len length of the dictionary
+ * @param p_in pointer to the compressed data
+ * @param len length of the compressed data
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the decompressed data, -EINVAL on invalid parameters,
+ * -EBADMSG if the block is malformed or does not fit the output buffer
+ */
+int uplinkDecompressWithDictionary(const uint8_t *p_dict, size_t dict_len, const uint8_t *p_in,
+                                   size_t len, uint8_t *p_out, size_t size);
+
+#endif // LMT_UPLINK_COMPRESS_H
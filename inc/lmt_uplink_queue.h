@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_UPLINK_QUEUE_H
+#define LMT_UPLINK_QUEUE_H
+
+#include "lmt_coap_manager.h"
+#include "lmt_proto_handler.h"
+#include "lmt_som_event_emitter.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Queue RAM in bytes, shared by the length-prefixed uplinks
+#define UPLINK_QUEUE_SIZE    CONFIG_LMTSDK_UPLINK_QUEUE_SIZE
+// Raw message budget, what is left of the CoAP message after the header
+#define UPLINK_QUEUE_MSG_SIZE         (APP_COAP_MAX_MSG_LEN - MAX_COAP_MESSAGE_HEAD_SIZE)
+// Record head, the protobuf framing of the uplink in a batch message
+#define UPLINK_QUEUE_RECORD_HEAD_SIZE 3
+
+#if defined(CONFIG_LMTSDK_UPLINK_QUEUE_BATCH)
+// Largest raw uplink, a batch of one uplink has to fit the message
+#define UPLINK_QUEUE_MAX_LEN (UPLINK_QUEUE_MSG_SIZE - UPLINK_QUEUE_RECORD_HEAD_SIZE)
+#else
+// Largest raw uplink
+#define UPLINK_QUEUE_MAX_LEN UPLINK_QUEUE_MSG_SIZE
+#endif
+
+/*
+ * Queue of raw data uplinks kept in a byte ring of length-prefixed records, so
+ * small uplinks take only their own size. The producer encodes straight into
+ * a reserved record and the record itself is handed to setRawData(), so the
+ * message is never copied before the mailer packs it into the CoAP queue.
+ * setRawData() keeps only the pointer, the record is released when the packer
+ * reports the message enqueued.
+ *
+ * With CONFIG_LMTSDK_UPLINK_QUEUE_BATCH up to CONFIG_LMTSDK_UPLINK_QUEUE_BATCH_MAX
+ * queued uplinks are handed over as one message, the protobuf encoding of a
+ * `repeated bytes` field 1 (e.g. TapeBatch of A2Tape.proto), so a backlog drains
+ * with one CoAP exchange per batch instead of one per uplink. Every message is
+ * a batch then, also of a single uplink. With CONFIG_LMTSDK_UPLINK_COMPRESS the
+ * uplinks that get smaller are sent as LZ4 blocks in field 2 (lmt_uplink_compress.h).
+ *
+ * With CONFIG_LMTSDK_UPLINK_SPILL the uplinks are held while the network is down
+ * and the oldest ones are moved to a flash journal (lmt_uplink_spill.h) when the
+ * ring is full. After EVENT_NETWORK_UP the journal is drained one uplink per
+ * CONFIG_LMTSDK_UPLINK_SPILL_DRAIN_INTERVAL_MS, only while no fresh uplinks wait.
+ *
+ * uplinkQueueOnEvent() must be called for the packer and network events, e.g. from
+ * an application handleSomEvent() override. With CONFIG_LMTSDK_EVENT_SUBSCRIBE it is
+ * subscribed to them at link time instead (lmt_event_subscribe.h).
+ */
+
+/**
+ * @brief Reserves a contiguous record for writing, spilling the oldest uplinks to
+ * flash if needed (CONFIG_LMTSDK_UPLINK_SPILL). Only one record can be reserved
+ * at a time, it is either committed with uplinkQueueCommit() or released with
+ * uplinkQueueAbort().
+ *
+ * @param size the largest length the producer may write, at most UPLINK_QUEUE_MAX_LEN
+ * @return pointer to the record, NULL if size is out of range, the queue has no room
+ * for it or a record is already reserved
+ */
+uint8_t *uplinkQueueReserve(size_t size);
+
+/**
+ * @brief Commits the reserved record as the newest uplink, only len bytes stay taken
+ *
+ * @param len length of the data written to the record, 0 releases the record
+ * @return 0 on success, -EINVAL if no record is reserved or len is larger than reserved
+ */
+int uplinkQueueCommit(size_t len);
+
+/**
+ * @brief Releases the reserved record without queueing it
+ */
+void uplinkQueueAbort(void);
+
+/**
+ * @brief Hands the oldest uplink (or batch of uplinks) to the mailer via setRawData().
+ * The following uplinks are handed over as the packer enqueues the previous message.
+ *
+ * @param upload Flag to trigger mailer for immediate upload
+ * @return 0 on success, -EBUSY if the packer has not taken the previous uplink yet
+ * (this one follows it), -EAGAIN if the uplinks are held while the network is down
+ * (CONFIG_LMTSDK_UPLINK_SPILL), -ENODATA if the queue is empty, -EPERM if not in raw data mode,
+ * negative error code of setRawData() on fail
+ */
+int uplinkQueueSend(bool upload);
+
+/**
+ * @brief Returns the number of queued uplinks, including the one handed to the mailer
+ *
+ * @return Queued uplink count
+ */
+size_t uplinkQueueGetCount(void);
+
+/**
+ * @brief Tracks the packer progress of the message handed to the mailer.
+ * EVENT_PACKER_DONE_OK releases its uplinks and hands over the next ones, a packing or
+ * enqueue failure keeps it for the next uplinkQueueSend(). EVENT_NETWORK_DOWN and
+ * EVENT_NETWORK_UP hold and resume the spill. Other events are ignored.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer (unused)
+ * @param i_data Event integer data (unused)
+ */
+void uplinkQueueOnEvent(SomEvent event, void *p_data, int i_data);
+
+#endif // LMT_UPLINK_QUEUE_H
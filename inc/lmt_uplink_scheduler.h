@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_UPLINK_SCHEDULER_H
+#define LMT_UPLINK_SCHEDULER_H
+
+#include "lmt_som_event_emitter.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// No RSRP from the connection evaluation or the library cache
+#define UPLINK_SCHEDULER_RSRP_UNKNOWN     INT32_MIN
+// No energy estimate, the lte_lc energy estimates are 5 (excessive) to 9 (efficient)
+#define UPLINK_SCHEDULER_ESTIMATE_UNKNOWN 0
+// LTE_LC_ENERGY_CONSUMPTION_NORMAL, the lowest estimate that counts as good
+#define UPLINK_SCHEDULER_ESTIMATE_NORMAL  7
+
+/**
+ * @brief Scheduler decision for the pending uplinks
+ */
+typedef enum
+{
+    UPLINK_SCHEDULER_WAIT,      /**< Keep the uplinks, check again later. */
+    UPLINK_SCHEDULER_SEND_GOOD, /**< Send, the quality is good. */
+    UPLINK_SCHEDULER_SEND_LATE  /**< Send, the uplinks waited the maximum latency. */
+} UplinkSchedulerDecision;
+
+/**
+ * @brief Scheduler counters since the boot
+ */
+typedef struct
+{
+    uint32_t requests;    // uplinkSchedulerRequest() calls
+    uint32_t urgent;      // Sent on an urgent request
+    uint32_t good;        // Sent in good quality
+    uint32_t late;        // Sent in poor quality at the maximum latency
+    uint32_t piggybacked; // Sent on an RRC connection that was up anyway
+    uint32_t deferred;    // Checks that kept the uplinks for poor quality
+    uint32_t eval_failed; // Checks without a connection evaluation, the cache was used
+    uint32_t max_wait_s;  // Longest wait from the request to the send
+    int32_t last_rsrp;    // RSRP of the last check in dBm
+} UplinkSchedulerStats;
+
+/*
+ * Uplink scheduler driven by the network quality. The mailer uploads on the
+ * setUplinkTimeout() timer or on a full message whatever the radio conditions, and an
+ * uplink in poor coverage takes more repetitions, transmit power and connected time
+ * (samples/uplink_scheduler_sim compares the two on a simulated RSRP trace).
+ * uplinkSchedulerStart() puts the mailer in WAIT_FOREVER mode and the scheduler
+ * triggers it instead:
+ *  - an urgent request is sent at once
+ *  - other requests wait at least CONFIG_LMTSDK_UPLINK_SCHEDULER_MIN_INTERVAL_S, so they
+ *    are batched like on the mailer timer, then the quality is checked every
+ *    CONFIG_LMTSDK_UPLINK_SCHEDULER_CHECK_INTERVAL_S and they are sent as soon as it
+ *    is good, at the latest after CONFIG_LMTSDK_UPLINK_SCHEDULER_MAX_LATENCY_S
+ *  - pending requests go with any RRC connection that is up anyway, e.g. an urgent
+ *    uplink or a downlink, as the connection costs the same
+ *
+ * The quality is the RSRP and energy estimate of the modem connection evaluation
+ * (lte_lc_conn_eval_params_get(), CONFIG_LTE_LC_CONN_EVAL_MODULE). When the modem cannot
+ * evaluate, e.g. in PSM, the RSRP cached by the library at the last connection
+ * (getNetworkQuality()) is used, and without either the quality counts as good.
+ *
+ * The data is handed over as before, e.g. with tapeSubmit(false) or uplinkQueueCommit(),
+ * followed by uplinkSchedulerRequest(). uplinkSchedulerOnEvent() must be called for the
+ * RRC, network down and uplink retry events, or is subscribed to them with
+ * CONFIG_LMTSDK_EVENT_SUBSCRIBE.
+ *
+ * samples/uplink_scheduler_sim replays an RSRP trace through the scheduler on native_sim.
+ */
+
+/**
+ * @brief Decides on the pending uplinks, the policy of the scheduler
+ *
+ * @param rsrp RSRP in dBm, UPLINK_SCHEDULER_RSRP_UNKNOWN if not known
+ * @param energy_estimate lte_lc energy estimate, UPLINK_SCHEDULER_ESTIMATE_UNKNOWN if not known
+ * @param waited_s seconds since the oldest pending request
+ * @return the decision
+ */
+UplinkSchedulerDecision uplinkSchedulerDecide(int32_t rsrp, int energy_estimate,
+                                              uint32_t waited_s);
+
+/**
+ * @brief Puts the mailer in WAIT_FOREVER mode, the scheduler triggers the uploads
+ *
+ * @return 0 on success, -EALREADY if started
+ */
+int uplinkSchedulerStart(void);
+
+/**
+ * @brief Sends the pending uplinks and returns the mailer to WAIT_ON_TIMEOUT mode
+ */
+void uplinkSchedulerStop(void);
+
+/**
+ * @brief Schedules the upload of the data handed to the mailer
+ *
+ * @param urgent send at once, whatever the quality
+ * @return 0 on success, -EPERM if the scheduler is not started
+ */
+int uplinkSchedulerRequest(bool urgent);
+
+/**
+ * @brief Copies the scheduler counters
+ *
+ * @param p_stats pointer to the output counters
+ * @return 0 on success, -EINVAL on invalid parameters
+ */
+int uplinkSchedulerGetStats(UplinkSchedulerStats *p_stats);
+
+/**
+ * @brief Tracks the RRC state for the piggybacked uplinks from EVENT_RRC_CONNECTED,
+ * EVENT_RRC_IDLE and EVENT_NETWORK_DOWN. EVENT_UL_MAX_RETRY puts the failed uplink back
+ * to pending with its first request time. Other events are ignored.
+ *
+ * @param event The event type
+ * @param p_data Event data pointer (unused)
+ * @param i_data Event integer data (unused)
+ */
+void uplinkSchedulerOnEvent(SomEvent event, void *p_data, int i_data);
+
+#endif // LMT_UPLINK_SCHEDULER_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LMT_UPLINK_SPILL_H
+#define LMT_UPLINK_SPILL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Journal file size limit in bytes, heads included
+#define UPLINK_SPILL_MAX_SIZE CONFIG_LMTSDK_UPLINK_SPILL_MAX_SIZE
+
+/*
+ * LittleFS journal the uplink queue spills its oldest uplinks to while the network
+ * is down. Every record carries a magic, its length and the CRC32 of the payload.
+ * The read offset is kept with a CRC in two side files written in turns, so the
+ * journal is drained in FIFO order across reboots and a torn position write repeats
+ * at most one uplink. A torn record left by a power cut is cut off when the journal
+ * is opened the first time after boot, scanning from the checked read offset only.
+ * Once an append would grow the journal past UPLINK_SPILL_MAX_SIZE, the removed
+ * records are compacted away: the rest is copied to a new journal generation that
+ * replaces the old one by a rename.
+ */
+
+/**
+ * @brief Appends an uplink to the end of the journal
+ *
+ * @param p_data pointer to the uplink
+ * @param len length of the uplink
+ * @return 0 on success, -EINVAL on invalid parameters, -ENOSPC if the journal is full,
+ * negative errno code of the file system on fail
+ */
+int uplinkSpillAppend(const uint8_t *p_data, size_t len);
+
+/**
+ * @brief Reads the oldest uplink of the journal without removing it
+ *
+ * @param p_buffer pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the uplink, -ENODATA if the journal is empty, -ENOMEM if the
+ * buffer is too small, -EBADMSG if the record is damaged (the journal is dropped
+ * from it on), negative errno code of the file system on fail
+ */
+int uplinkSpillPeek(uint8_t *p_buffer, size_t size);
+
+/**
+ * @brief Removes the oldest uplink of the journal. The journal is deleted once empty.
+ *
+ * @return 0 on success, -ENODATA if the journal is empty, negative errno code on fail
+ */
+int uplinkSpillPop(void);
+
+/**
+ * @brief Returns the number of uplinks in the journal
+ *
+ * @return Uplink count
+ */
+size_t uplinkSpillGetCount(void);
+
+#if defined(CONFIG_ZTEST)
+/**
+ * @brief Forgets the journal state kept in RAM, as a reboot does, so the next call
+ * recovers the journal from flash. For tests only.
+ */
+void uplinkSpillTestReboot(void);
+#endif
+
+#endif // LMT_UPLINK_SPILL_H
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2026 LMT
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Built into the native simulator runner: the embedded code sees only the simulated
+ * time, which does not pass while it computes.
+ */
+uint64_t benchClockNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2026 LMT
+ */
+
+#include "lmt_host_shim.h"
+#include "lmt_log_store.h"
+#include "lmt_tape_packer.h"
+#include "lmt_uplink_compress.h"
+#include "lmt_uplink_queue.h"
+#include <posix_board_if.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/stats/stats.h>
+
+// Same data on every run, only the times depend on the host
+#define BENCH_SEED        0x2545F491U
+#define BENCH_OPS         2000
+#define BENCH_LOG_LINES   20000
+// Lines of the flash counts, reported per 1000 lines
+#define BENCH_FLASH_LINES 5000
+// Text log of benchFlashTextLog(), appended and synced line by line
+#define BENCH_TEXT_LOG    "/lfs/bench.log"
+// Log store backend of flash_logstore and append_logstore, see partition.conf
+#define BENCH_BACKEND     (IS_ENABLED(CONFIG_LMTSDK_LOG_STORE_PARTITION) ? "partition" : "littlefs")
+#define BENCH_TAPE        0
+#define BENCH_PERIOD      60
+#define BENCH_TRACKS      6
+
+// Counters of the flash simulator (CONFIG_FLASH_SIMULATOR_STATS)
+typedef struct
+{
+    uint32_t write_calls;
+    uint32_t erase_calls;
+    uint32_t bytes_written;
+} FlashCounts;
+
+typedef struct
+{
+    const char *p_name;
+    uint32_t ops;
+    uint32_t failed;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t bytes;
+} BenchResult;
+
+// Host monotonic clock, see src/host/bench_clock.c
+uint64_t benchClockNs(void);
+
+static uint32_t random_state;
+static int32_t column[MAX_TRACKS_COUNT];
+static uint8_t encoded[UPLINK_QUEUE_MAX_LEN];
+static size_t encoded_len;
+static uint8_t compressed[UPLINK_QUEUE_MAX_LEN * 2];
+static uint8_t dictionary[UPLINK_QUEUE_MAX_LEN];
+static int32_t decoded[TAPE_MAX_COLUMNS_COUNT * MAX_TRACKS_COUNT];
+// Append latency of every line of the flash benchmarks, for the percentiles
+static uint32_t append_ns[BENCH_FLASH_LINES];
+
+void handleSomEvent(SomEvent event, void *p_data, int i_data)
+{
+    uplinkQueueOnEvent(event, p_data, i_data);
+}
+
+static uint32_t nextRandom(void)
+{
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+static void resetData(void)
+{
+    static const int32_t base[BENCH_TRACKS] = {2150, 101325, 4500, 3600, -75, 12};
+
+    random_state = BENCH_SEED;
+    memcpy(column, base, sizeof(base));
+}
+
+// Sensor-like columns: small steps from the previous value
+static const int32_t *nextColumn(void)
+{
+    for(int i = 0; i < BENCH_TRACKS; i++)
+    {
+        column[i] += (int32_t)(nextRandom() % 9) - 4;
+    }
+
+    return column;
+}
+
+static void startResult(BenchResult *p_result, const char *p_name)
+{
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->p_name = p_name;
+    p_result->min_ns = UINT64_MAX;
+    resetData();
+}
+
+static void addSample(BenchResult *p_result, uint64_t start, int ret)
+{
+    uint64_t ns = benchClockNs() - start;
+
+    if(ret < 0)
+    {
+        p_result->failed++;
+        return;
+    }
+
+    p_result->ops++;
+    p_result->total_ns += ns;
+    p_result->min_ns    = MIN(p_result->min_ns, ns);
+    p_result->max_ns    = MAX(p_result->max_ns, ns);
+}
+
+static void printResult(const BenchResult *p_result)
+{
+    uint64_t avg = p_result->ops ? p_result->total_ns / p_result->ops : 0;
+
+    printk("%-14s ops=%u failed=%u avg=%u ns min=%u ns max=%u ns ops/s=%u bytes/op=%u\n",
+           p_result->p_name, p_result->ops, p_result->failed, (uint32_t)avg,
+           p_result->ops ? (uint32_t)p_result->min_ns : 0, (uint32_t)p_result->max_ns,
+           avg ? (uint32_t)(NSEC_PER_SEC / avg) : 0,
+           p_result->ops ? (uint32_t)(p_result->bytes / p_result->ops) : 0);
+}
+
+// Fills the Tape until the next column would not fit the uplink
+static void fillTape(void)
+{
+    tapeRewind(BENCH_TAPE);
+    while(tapeAddColumn(BENCH_TAPE, BENCH_PERIOD, nextColumn()) > 0)
+    {
+    }
+}
+
+static void benchTapeAppend(void)
+{
+    BenchResult result;
+    uint64_t start;
+    int ret;
+
+    startResult(&result, "tape_append");
+    tapeRewind(BENCH_TAPE);
+    for(int i = 0; i < BENCH_OPS; i++)
+    {
+        const int32_t *p_column = nextColumn();
+
+        start = benchClockNs();
+        ret   = tapeAddColumn(BENCH_TAPE, BENCH_PERIOD, p_column);
+        if(ret == -ENOSPC)
+        {
+            // A full uplink is not an append, start the next one
+            tapeRewind(BENCH_TAPE);
+            start = benchClockNs();
+            ret   = tapeAddColumn(BENCH_TAPE, BENCH_PERIOD, p_column);
+        }
+        addSample(&result, start, ret);
+    }
+    printResult(&result);
+}
+
+static void benchTapeEncode(void)
+{
+    BenchResult result;
+    uint64_t start;
+    int ret;
+
+    startResult(&result, "tape_encode");
+    fillTape();
+    for(int i = 0; i < BENCH_OPS; i++)
+    {
+        start = benchClockNs();
+        ret   = tapeEncode(encoded, sizeof(encoded), &encoded_len);
+        addSample(&result, start, ret);
+        result.bytes += encoded_len;
+    }
+    printResult(&result);
+}
+
+static void benchTapeDecode(void)
+{
+    BenchResult result;
+    uint64_t start;
+    int ret;
+
+    // Decodes the uplink of benchTapeEncode()
+    startResult(&result, "tape_decode");
+    for(int i = 0; i < BENCH_OPS; i++)
+    {
+        start = benchClockNs();
+        ret   = tapeDecode(encoded, encoded_len, BENCH_TAPE, decoded, TAPE_MAX_COLUMNS_COUNT);
+        addSample(&result, start, ret);
+        result.bytes += encoded_len;
+    }
+    printResult(&result);
+}
+
+static void benchTapeSubmit(void)
+{
+    BenchResult result;
+    uint64_t start;
+    int ret;
+
+    startResult(&result, "tape_submit");
+    for(int i = 0; i < BENCH_OPS; i++)
+    {
+        fillTape();
+        start = benchClockNs();
+        ret   = tapeSubmit(false);
+        addSample(&result, start, ret);
+        // The mailer takes the record, which releases it
+        ret = hostShimPack();
+        result.bytes += MAX(ret, 0);
+    }
+    printResult(&result);
+}
+
+// Encoded size of a full uplink by the Tracks in use, Tracks past BENCH_TRACKS stay 0
+static void benchTapeTracks(void)
+{
+    static const uint8_t track_counts[] = {1, 4, MAX_TRACKS_COUNT};
+    static const char *const encoding_names[] = {"absolute", "delta"};
+    uint32_t columns;
+
+    for(int encoding = TAPE_ABSOLUTE; encoding <= TAPE_DELTA_ZIGZAG; encoding++)
+    {
+        for(size_t i = 0; i < ARRAY_SIZE(track_counts); i++)
+        {
+            resetData();
+            tapeSetEncoding(BENCH_TAPE, encoding);
+            tapeSetTrackMask(BENCH_TAPE, BIT_MASK(track_counts[i]));
+            fillTape();
+            tapeEncode(encoded, sizeof(encoded), &encoded_len);
+            columns = tapeGetRecordsCount(BENCH_TAPE);
+            printk("tape_tracks    encoding=%s tracks=%u columns=%u bytes=%u bytes/column=%u\n",
+                   encoding_names[encoding], track_counts[i], columns, (uint32_t)encoded_len,
+                   (uint32_t)(encoded_len / MAX(columns, 1)));
+        }
+    }
+
+    tapeSetEncoding(BENCH_TAPE, TAPE_DELTA_ZIGZAG);
+    tapeSetTrackMask(BENCH_TAPE, BIT_MASK(BENCH_TRACKS));
+}
+
+static void benchCompress(void)
+{
+    BenchResult result;
+    uint64_t start;
+    int ret;
+
+    // Compresses the uplink of benchTapeEncode()
+    startResult(&result, "compress");
+    for(int i = 0; i < BENCH_OPS; i++)
+    {
+        start = benchClockNs();
+        ret   = uplinkCompress(encoded, encoded_len, compressed, sizeof(compressed));
+        addSample(&result, start, ret);
+        result.bytes += MAX(ret, 0);
+    }
+    printResult(&result);
+}
+
+static void benchCompressDictionary(void)
+{
+    BenchResult result;
+    uint64_t start;
+    size_t dictionary_len;
+    int ret;
+
+    // The uplink of benchTapeEncode() is the dictionary of the next one
+    startResult(&result, "compress_dict");
+    memcpy(dictionary, encoded, encoded_len);
+    dictionary_len = encoded_len;
+    fillTape();
+    tapeEncode(encoded, sizeof(encoded), &encoded_len);
+    uplinkCompressSetDictionary(dictionary, dictionary_len);
+    for(int i = 0; i < BENCH_OPS; i++)
+    {
+        start = benchClockNs();
+        ret   = uplinkCompress(encoded, encoded_len, compressed, sizeof(compressed));
+        addSample(&result, start, ret);
+        result.bytes += MAX(ret, 0);
+    }
+    uplinkCompressSetDictionary(NULL, 0);
+    printResult(&result);
+}
+
+static void benchLogAppend(void)
+{
+    BenchResult result;
+    uint64_t start;
+    int ret;
+
+    startResult(&result, "log_append");
+    for(int i = 0; i < BENCH_LOG_LINES; i++)
+    {
+        start = benchClockNs();
+        ret   = logStoreWriteFormatted(LOG_INFORMATIVE, "sensor %d t=%d p=%d", i, column[0],
+                                       column[1]);
+        addSample(&result, start, ret);
+        nextColumn();
+
+        if((i % LOG_STORE_QUEUE_LENGTH) == (LOG_STORE_QUEUE_LENGTH - 1))
+        {
+            // Let the low priority store thread empty the queue
+            k_msleep(1);
+        }
+    }
+    printResult(&result);
+
+    startResult(&result, "log_flush");
+    start = benchClockNs();
+    ret   = logStoreFlush();
+    addSample(&result, start, ret);
+    printResult(&result);
+}
+
+static int readFlashCount(struct stats_hdr *p_hdr, void *p_arg, const char *p_name,
+                          uint16_t offset)
+{
+    FlashCounts *p_counts = p_arg;
+    uint32_t value        = *(uint32_t *)((uint8_t *)p_hdr + offset);
+
+    if(strcmp(p_name, "flash_write_calls") == 0)
+    {
+        p_counts->write_calls = value;
+    }
+    else if(strcmp(p_name, "flash_erase_calls") == 0)
+    {
+        p_counts->erase_calls = value;
+    }
+    else if(strcmp(p_name, "bytes_written") == 0)
+    {
+        p_counts->bytes_written = value;
+    }
+
+    return 0;
+}
+
+static void getFlashCounts(FlashCounts *p_counts)
+{
+    struct stats_hdr *p_hdr = stats_group_find("flash_sim_stats");
+
+    memset(p_counts, 0, sizeof(*p_counts));
+    if(p_hdr != NULL)
+    {
+        stats_walk(p_hdr, readFlashCount, p_counts);
+    }
+}
+
+static void printFlashCounts(const char *p_name, const FlashCounts *p_start)
+{
+    FlashCounts end;
+
+    getFlashCounts(&end);
+    printk("%-14s lines=%u writes/1000=%u erases/1000=%u bytes/1000=%u\n", p_name,
+           BENCH_FLASH_LINES,
+           (end.write_calls - p_start->write_calls) * 1000 / BENCH_FLASH_LINES,
+           (end.erase_calls - p_start->erase_calls) * 1000 / BENCH_FLASH_LINES,
+           (end.bytes_written - p_start->bytes_written) / (BENCH_FLASH_LINES / 1000));
+}
+
+static int compareNs(const void *p_a, const void *p_b)
+{
+    uint32_t a = *(const uint32_t *)p_a;
+    uint32_t b = *(const uint32_t *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+static void printAppendLatency(const char *p_name)
+{
+    qsort(append_ns, BENCH_FLASH_LINES, sizeof(append_ns[0]), compareNs);
+    printk("%-14s lines=%u p50=%u ns p99=%u ns max=%u ns\n", p_name, BENCH_FLASH_LINES,
+           append_ns[BENCH_FLASH_LINES / 2], append_ns[BENCH_FLASH_LINES * 99 / 100],
+           append_ns[BENCH_FLASH_LINES - 1]);
+}
+
+// Per-line appends and syncs of a text file, every line on flash when the call returns
+static void benchFlashTextLog(void)
+{
+    struct fs_file_t file;
+    FlashCounts start;
+    char line[LOG_STORE_RECORD_SIZE];
+    int len;
+
+    resetData();
+    fs_file_t_init(&file);
+    if(fs_open(&file, BENCH_TEXT_LOG, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND))
+    {
+        printk("flash_text     failed to open %s\n", BENCH_TEXT_LOG);
+        return;
+    }
+
+    getFlashCounts(&start);
+    for(int i = 0; i < BENCH_FLASH_LINES; i++)
+    {
+        uint64_t line_start = benchClockNs();
+
+        len = snprintk(line, sizeof(line), "%lld I sensor %d t=%d p=%d\n", k_uptime_get(), i,
+                       column[0], column[1]);
+        fs_write(&file, line, MIN(len, sizeof(line) - 1));
+        fs_sync(&file);
+        append_ns[i] = (uint32_t)MIN(benchClockNs() - line_start, UINT32_MAX);
+        nextColumn();
+    }
+    fs_close(&file);
+    printFlashCounts("flash_text", &start);
+    printAppendLatency("append_text");
+
+    fs_unlink(BENCH_TEXT_LOG);
+}
+
+/*
+ * The same lines through the log store, written a page at a time. A line is timed until
+ * the store thread has taken it, so the compression of a full block and the page writes
+ * and erases of the backend fall on the line that triggers them and show in the p99.
+ */
+static void benchFlashLogStore(void)
+{
+    FlashCounts start;
+
+    resetData();
+    logStoreFlush();
+
+    getFlashCounts(&start);
+    for(int i = 0; i < BENCH_FLASH_LINES; i++)
+    {
+        uint64_t line_start = benchClockNs();
+
+        logStoreWriteFormatted(LOG_INFORMATIVE, "sensor %d t=%d p=%d", i, column[0], column[1]);
+        // Lets the low priority store thread run
+        k_msleep(1);
+        append_ns[i] = (uint32_t)MIN(benchClockNs() - line_start, UINT32_MAX);
+        nextColumn();
+    }
+    logStoreFlush();
+    printFlashCounts("flash_logstore", &start);
+    printAppendLatency("append_logstore");
+}
+
+int main(void)
+{
+    printk("lmtSDK core benchmark, seed 0x%08x, log store on %s\n", BENCH_SEED, BENCH_BACKEND);
+
+    tapeSetEncoding(BENCH_TAPE, TAPE_DELTA_ZIGZAG);
+    tapeSetTrackMask(BENCH_TAPE, BIT_MASK(BENCH_TRACKS));
+
+    benchTapeAppend();
+    benchTapeEncode();
+    benchTapeDecode();
+    benchTapeSubmit();
+    benchCompress();
+    benchCompressDictionary();
+    benchTapeTracks();
+    benchLogAppend();
+    benchFlashTextLog();
+    benchFlashLogStore();
+
+    posix_exit(0);
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 LMT
+ */
+
+#include "lmt_host_shim.h"
+#include "lmt_uplink_scheduler.h"
+#include <posix_board_if.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+// Same trace on every run
+#define TRACE_SEED         0x9E3779B9U
+#define TRACE_STEP_S       60
+#define TRACE_STEPS        (48 * 60) // 48 hours
+// Slow fading as a triangle wave around the base, with noise on top
+#define TRACE_BASE_DBM     -106
+#define TRACE_SWING_DB     12
+#define TRACE_PERIOD_STEPS 240
+#define TRACE_NOISE_DB     4
+
+#define MEASUREMENT_BYTES  24 // One measurement per step
+
+/*
+ * Rough cost model of one uplink, not measured: the setup and airtime repeat twice for
+ * every COVERAGE_STEP_DB below COVERAGE_REF_DBM (CE level repetitions, up to 8 times),
+ * the RRC tail after the release assistance does not.
+ */
+#define COVERAGE_REF_DBM   -100
+#define COVERAGE_STEP_DB   8
+#define SETUP_MS           400
+#define BYTES_PER_MS       2
+#define TAIL_MS            2000
+#define CONNECTED_MA       50
+
+typedef struct
+{
+    const char *p_name;
+    uint32_t uplinks;
+    uint32_t bytes;         // Delivered bytes
+    uint64_t charge_uc;
+    uint32_t max_latency_s;
+    int64_t rsrp_sum;       // Of the uplinks
+    uint32_t pending_bytes;
+    uint32_t oldest_s;      // Time of the oldest pending measurement
+} PolicyResult;
+
+static uint32_t random_state = TRACE_SEED;
+static int16_t trace[TRACE_STEPS];
+
+static uint32_t nextRandom(void)
+{
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+static int32_t traceRsrp(uint32_t step)
+{
+    uint32_t half  = TRACE_PERIOD_STEPS / 2;
+    uint32_t phase = step % TRACE_PERIOD_STEPS;
+    int32_t wave   = (phase < half) ? phase : TRACE_PERIOD_STEPS - phase;
+    int32_t noise  = (int32_t)(nextRandom() % (2 * TRACE_NOISE_DB + 1)) - TRACE_NOISE_DB;
+
+    return TRACE_BASE_DBM - TRACE_SWING_DB + (2 * TRACE_SWING_DB * wave) / (int32_t)half +
+           noise;
+}
+
+static uint64_t uplinkChargeUc(int32_t rsrp, uint32_t bytes)
+{
+    int32_t steps = (COVERAGE_REF_DBM - rsrp + COVERAGE_STEP_DB - 1) / COVERAGE_STEP_DB;
+    uint32_t airtime_ms = (SETUP_MS + bytes / BYTES_PER_MS) << CLAMP(steps, 0, 3);
+
+    return (uint64_t)(airtime_ms + TAIL_MS) * CONNECTED_MA;
+}
+
+static void addMeasurement(PolicyResult *p_result, uint32_t now_s)
+{
+    if(p_result->pending_bytes == 0)
+    {
+        p_result->oldest_s = now_s;
+    }
+    p_result->pending_bytes += MEASUREMENT_BYTES;
+}
+
+static void sendPending(PolicyResult *p_result, uint32_t now_s, int32_t rsrp)
+{
+    if(p_result->pending_bytes == 0)
+    {
+        return;
+    }
+
+    p_result->uplinks++;
+    p_result->bytes         += p_result->pending_bytes;
+    p_result->charge_uc     += uplinkChargeUc(rsrp, p_result->pending_bytes);
+    p_result->rsrp_sum      += rsrp;
+    p_result->max_latency_s  = MAX(p_result->max_latency_s, now_s - p_result->oldest_s);
+    p_result->pending_bytes  = 0;
+}
+
+/**
+ * @brief Replays the trace with the mailer timer, which sends whatever the quality
+ *
+ * @param p_result pointer to the result of the policy
+ * @param interval_s the timer interval
+ */
+static void runFixed(PolicyResult *p_result, uint32_t interval_s)
+{
+    for(uint32_t step = 0; step < TRACE_STEPS; step++)
+    {
+        uint32_t now_s = step * TRACE_STEP_S;
+
+        addMeasurement(p_result, now_s);
+        if(now_s - p_result->oldest_s >= interval_s)
+        {
+            sendPending(p_result, now_s, trace[step]);
+        }
+    }
+}
+
+static void printResult(const PolicyResult *p_result)
+{
+    uint32_t uc_per_byte_x100 = p_result->bytes ? p_result->charge_uc * 100 / p_result->bytes : 0;
+
+    printk("%-8s uplinks=%u bytes=%u charge=%u mC uC/byte=%u.%02u max_latency=%u s "
+           "avg_rsrp=%d dBm\n",
+           p_result->p_name, p_result->uplinks, p_result->bytes,
+           (uint32_t)(p_result->charge_uc / 1000), uc_per_byte_x100 / 100,
+           uc_per_byte_x100 % 100, p_result->max_latency_s,
+           p_result->uplinks ? (int32_t)(p_result->rsrp_sum / p_result->uplinks) : 0);
+}
+
+int main(void)
+{
+    PolicyResult fixed      = {.p_name = "fixed"};
+    PolicyResult fixed_mean = {.p_name = "fixed_n"};
+    PolicyResult adaptive   = {.p_name = "adaptive"};
+    UplinkSchedulerStats stats;
+    uint32_t mean_interval_s;
+    uint32_t triggers;
+
+    printk("lmtSDK uplink scheduler simulation, seed 0x%08x, %u h, good RSRP %d dBm\n",
+           TRACE_SEED, TRACE_STEPS * TRACE_STEP_S / 3600,
+           CONFIG_LMTSDK_UPLINK_SCHEDULER_GOOD_RSRP);
+
+    for(uint32_t step = 0; step < TRACE_STEPS; step++)
+    {
+        trace[step] = traceRsrp(step);
+    }
+
+    uplinkSchedulerStart();
+    for(uint32_t step = 0; step < TRACE_STEPS; step++)
+    {
+        uint32_t now_s = step * TRACE_STEP_S;
+        int32_t rsrp   = trace[step];
+
+        hostShimSetNetworkQuality(rsrp, -10, 5);
+
+        // Requests in the middle of a step, so the scheduler checks see this step's quality
+        addMeasurement(&adaptive, now_s);
+        triggers = hostShimGetMailerTriggers();
+        k_sleep(K_SECONDS(TRACE_STEP_S / 2));
+        uplinkSchedulerRequest(false);
+        k_sleep(K_SECONDS(TRACE_STEP_S / 2));
+        if(hostShimGetMailerTriggers() != triggers)
+        {
+            sendPending(&adaptive, now_s + TRACE_STEP_S / 2, rsrp);
+        }
+    }
+
+    // The timer at the mean interval of the adaptive policy sends about as many uplinks of
+    // the same size, so the difference is the radio quality at the time of the send
+    mean_interval_s = TRACE_STEPS * TRACE_STEP_S / MAX(adaptive.uplinks, 1);
+    runFixed(&fixed, CONFIG_LMTSDK_UPLINK_SCHEDULER_MIN_INTERVAL_S);
+    runFixed(&fixed_mean, mean_interval_s);
+
+    printResult(&fixed);
+    printk("fixed_n  interval=%u s, the mean interval of the adaptive uplinks\n",
+           mean_interval_s);
+    printResult(&fixed_mean);
+    printResult(&adaptive);
+
+    uplinkSchedulerGetStats(&stats);
+    printk("scheduler requests=%u good=%u late=%u deferred=%u max_wait=%u s\n", stats.requests,
+           stats.good, stats.late, stats.deferred, stats.max_wait_s);
+
+    posix_exit(0);
+
+    return 0;
+}
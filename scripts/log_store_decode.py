@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+
+# Copyright 2026 Latvijas Mobilais Telefons
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Decodes log store files (lmt_log_store.h) block by block, so a partly
+# uploaded file prints every block that has arrived. Dictionary blocks
+# (CONFIG_LMTSDK_LOG_STORE_DICTIONARY) need the ELF of the same build.
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+BLOCK_MAGIC = 0x424C
+DICTIONARY_BLOCK_MAGIC = 0x444C
+BLOCK_HEAD = struct.Struct("<HHHHIB3xqq")
+RECORD_HEAD = struct.Struct("<BHqi")
+FORMAT_BASE = b"log_store_format_base"
+LEVEL_LETTERS = "EWI"
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t)?(.)", re.S)
+
+class ElfStrings:
+    """Reads the format strings from the loaded sections of the firmware ELF.
+
+    The records keep the offset of the format string from log_store_format_base,
+    which is looked up in the symbol table.
+    """
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+        wide = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        if wide:
+            shoff, = struct.unpack_from(endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x3A)
+            section = struct.Struct(endian + "IIQQQQI")
+            symbol = struct.Struct(endian + "I4xQ8x")
+        else:
+            shoff, = struct.unpack_from(endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data, 0x2E)
+            section = struct.Struct(endian + "IIIIIII")
+            symbol = struct.Struct(endian + "II8x")
+        headers = [section.unpack_from(self.data, shoff + i * shentsize) for i in range(shnum)]
+        self.sections = []
+        self.base = None
+        for _, sh_type, flags, addr, offset, size, link in headers:
+            # Allocated sections with file contents (not SHT_NOBITS)
+            if flags & 0x2 and sh_type != 8 and addr:
+                self.sections.append((addr, offset, size))
+            # SHT_SYMTAB, names in the linked string table
+            if sh_type == 2 and self.base is None:
+                names = headers[link][4]
+                for start in range(offset, offset + size, symbol.size):
+                    name, value = symbol.unpack_from(self.data, start)
+                    end = self.data.index(b"\0", names + name)
+                    if self.data[names + name:end] == FORMAT_BASE:
+                        self.base = value
+                        break
+        if self.base is None:
+            raise ValueError(f"{path} has no {FORMAT_BASE.decode()} symbol")
+        self.cache = {}
+
+    def string(self, format_offset):
+        address = self.base + format_offset
+        if address not in self.cache:
+            text = None
+            for addr, offset, size in self.sections:
+                if addr <= address < addr + size:
+                    start = offset + address - addr
+                    end = self.data.index(b"\0", start)
+                    text = self.data[start:end].decode("utf-8", errors="replace")
+                    break
+            self.cache[address] = text
+        return self.cache[address]
+
+def lz4_block_decompress(data, raw_len):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        token = data[i]
+        i += 1
+        literals = token >> 4
+        if literals == 15:
+            while True:
+                value = data[i]
+                i += 1
+                literals += value
+                if value != 255:
+                    break
+        out += data[i:i + literals]
+        i += literals
+        if i >= len(data):
+            break
+        offset = data[i] | (data[i + 1] << 8)
+        i += 2
+        match = token & 15
+        if match == 15:
+            while True:
+                value = data[i]
+                i += 1
+                match += value
+                if value != 255:
+                    break
+        match += 4
+        if offset == 0 or offset > len(out):
+            raise ValueError("bad match offset")
+        for _ in range(match):
+            out.append(out[-offset])
+    if len(out) != raw_len:
+        raise ValueError("bad block length")
+    return bytes(out)
+
+def take(args, offset, fmt):
+    value, = struct.unpack_from("<" + fmt, args, offset)
+    return value, offset + struct.calcsize(fmt)
+
+def expand(fmt, args):
+    """Formats the packed arguments the way the device packed them (packArgs())."""
+    out = []
+    offset = 0
+    position = 0
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[position:match.start()])
+        position = match.end()
+        flags, width, precision, length, conversion = match.groups()
+        if conversion == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width, offset = take(args, offset, "i")
+            width = str(width)
+        if precision == "*":
+            precision, offset = take(args, offset, "i")
+            precision = str(precision)
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+        if conversion in "diouxXc":
+            wide = length in ("ll", "j")
+            signed = conversion in "di"
+            value, offset = take(args, offset, ("q" if wide else "i") if signed else
+                                 ("Q" if wide else "I"))
+            if length in ("h", "hh"):
+                bits = 16 if length == "h" else 8
+                value &= (1 << bits) - 1
+                if signed and value >= 1 << (bits - 1):
+                    value -= 1 << bits
+            if conversion == "c":
+                out.append((spec + "c") % chr(value & 0xFF))
+            else:
+                out.append((spec + conversion.replace("i", "d").replace("u", "d")) % value)
+        elif conversion in "eEfFgGaA":
+            value, offset = take(args, offset, "d")
+            out.append(value.hex() if conversion in "aA" else (spec + conversion) % value)
+        elif conversion == "p":
+            value, offset = take(args, offset, "I")
+            out.append("0x%x" % value)
+        elif conversion == "s":
+            end = args.index(b"\0", offset)
+            out.append((spec + "s") % args[offset:end].decode("utf-8", errors="replace"))
+            offset = end + 1
+        elif conversion != "n":
+            # Not packed by the device either
+            position = match.start()
+            break
+    out.append(fmt[position:])
+    return "".join(out)
+
+def decode_records(data, elf):
+    offset = 0
+    while offset + RECORD_HEAD.size <= len(data):
+        level, length, timestamp, format_offset = RECORD_HEAD.unpack_from(data, offset)
+        args = data[offset + RECORD_HEAD.size:offset + RECORD_HEAD.size + length]
+        offset += RECORD_HEAD.size + length
+        fmt = elf.string(format_offset) if elf else None
+        if fmt is None:
+            text = f"<format {format_offset:+d}: {args.hex()}>"
+        else:
+            text = expand(fmt, args)
+        letter = LEVEL_LETTERS[level] if level < len(LEVEL_LETTERS) else "?"
+        yield f"{timestamp} {letter} {text}\n".encode("utf-8")
+
+def decode_blocks(data, elf=None):
+    """Yields the text of every complete block, stops at a torn or damaged one."""
+    offset = 0
+    while offset + BLOCK_HEAD.size <= len(data):
+        magic, raw_len, length, records, crc, _, _, _ = BLOCK_HEAD.unpack_from(data, offset)
+        payload = data[offset + BLOCK_HEAD.size:offset + BLOCK_HEAD.size + length]
+        if (magic not in (BLOCK_MAGIC, DICTIONARY_BLOCK_MAGIC) or len(payload) != length or
+                zlib.crc32(payload) != crc):
+            print(f"Damaged block at offset {offset}, stopping", file=sys.stderr)
+            return
+        raw = payload if length == raw_len else lz4_block_decompress(payload, raw_len)
+        if magic == DICTIONARY_BLOCK_MAGIC:
+            yield b"".join(decode_records(raw, elf))
+        else:
+            yield raw
+        offset += BLOCK_HEAD.size + length
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode lmtSDK log store files to text.")
+    parser.add_argument("files", nargs="+", help="log_<sequence>.lz4 files, oldest first")
+    parser.add_argument("-e", "--elf", help="zephyr.elf of the build that wrote dictionary logs")
+    args = parser.parse_args()
+    elf = ElfStrings(args.elf) if args.elf else None
+
+    for name in args.files:
+        with open(name, "rb") as f:
+            data = f.read()
+        for text in decode_blocks(data, elf):
+            sys.stdout.write(text.decode("utf-8", errors="replace"))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_coap_rto.h"
+#include "lmt_event_subscribe.h"
+#include "lmt_settings.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#define RTO_MIN_MS (CONFIG_LMTSDK_COAP_RTO_MIN_S * MSEC_PER_SEC)
+#define RTO_MAX_MS (CONFIG_LMTSDK_COAP_RTO_MAX_S * MSEC_PER_SEC)
+// Clock granularity G of RFC 6298, the wait is set in whole seconds
+#define RTO_GRANULARITY_MS MSEC_PER_SEC
+#define RTO_K              4
+
+static CoapRtoStats stats;
+static int64_t exchange_start; // Uptime ms of EVENT_COAP_START, 0 when none is open
+static bool timed_out;         // The uplink had a timeout, its ACKs are ambiguous
+static uint8_t configured_wait_s; // Wait before the first change, 0 when not changed
+static uint32_t resets;           // coapRtoReset() calls, drops a wait computed before one
+
+static struct k_spinlock rto_lock;
+
+static uint32_t boundRto(uint32_t rto_ms)
+{
+    return CLAMP(rto_ms, RTO_MIN_MS, RTO_MAX_MS);
+}
+
+static void sampleLocked(uint32_t rtt_ms)
+{
+    uint32_t delta;
+
+    if(stats.samples == 0)
+    {
+        stats.srtt_ms    = rtt_ms;
+        stats.rttvar_ms  = rtt_ms / 2;
+        stats.min_rtt_ms = rtt_ms;
+    }
+    else
+    {
+        delta = (stats.srtt_ms > rtt_ms) ? stats.srtt_ms - rtt_ms : rtt_ms - stats.srtt_ms;
+        stats.rttvar_ms = (3 * stats.rttvar_ms + delta) / 4;
+        stats.srtt_ms   = (7 * stats.srtt_ms + rtt_ms) / 8;
+    }
+
+    stats.samples++;
+    stats.last_rtt_ms = rtt_ms;
+    stats.min_rtt_ms  = MIN(stats.min_rtt_ms, rtt_ms);
+    stats.max_rtt_ms  = MAX(stats.max_rtt_ms, rtt_ms);
+    stats.rto_ms      = boundRto(stats.srtt_ms + MAX(RTO_GRANULARITY_MS, RTO_K * stats.rttvar_ms));
+}
+
+/**
+ * @brief Returns the wait to set for the RTO, 0 if it is already set
+ */
+static uint8_t waitToSetLocked(void)
+{
+    uint8_t wait_s = DIV_ROUND_UP(stats.rto_ms, MSEC_PER_SEC);
+
+    if(stats.rto_ms == 0 || wait_s == stats.wait_s)
+    {
+        return 0;
+    }
+
+    stats.wait_s = wait_s;
+
+    return wait_s;
+}
+
+int coapRtoGetStats(CoapRtoStats *p_stats)
+{
+    k_spinlock_key_t key;
+
+    if(p_stats == NULL)
+    {
+        return -EINVAL;
+    }
+
+    key      = k_spin_lock(&rto_lock);
+    *p_stats = stats;
+    k_spin_unlock(&rto_lock, key);
+
+    return 0;
+}
+
+void coapRtoReset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&rto_lock);
+    uint8_t wait_s       = configured_wait_s;
+
+    memset(&stats, 0, sizeof(stats));
+    exchange_start    = 0;
+    timed_out         = false;
+    configured_wait_s = 0;
+    resets++;
+    k_spin_unlock(&rto_lock, key);
+
+    if(wait_s != 0)
+    {
+        setResponseWaitTimeout(wait_s);
+    }
+}
+
+int coapRtoFormat(char *p_out, size_t size)
+{
+    CoapRtoStats copy;
+    int len;
+
+    if(p_out == NULL || size == 0)
+    {
+        return -EINVAL;
+    }
+
+    coapRtoGetStats(&copy);
+    len = snprintk(p_out, size,
+                  "rtt n=%u srtt=%u ms rttvar=%u ms min=%u ms max=%u ms rto=%u ms wait=%u s "
+                  "timeouts=%u ambiguous=%u\n",
+                  copy.samples, copy.srtt_ms, copy.rttvar_ms, copy.min_rtt_ms, copy.max_rtt_ms,
+                  copy.rto_ms, copy.wait_s, copy.timeouts, copy.ambiguous);
+
+    return MIN(len, (int)size - 1);
+}
+
+void coapRtoOnEvent(SomEvent event, void *p_data, int i_data)
+{
+    k_spinlock_key_t key;
+    int64_t now = k_uptime_get();
+    uint32_t resets_seen;
+    uint8_t current_s;
+    uint8_t wait_s;
+    bool apply;
+
+    ARG_UNUSED(p_data);
+    ARG_UNUSED(i_data);
+
+    key = k_spin_lock(&rto_lock);
+    switch(event)
+    {
+        case EVENT_COAP_START:
+            // Never 0, that marks no open exchange
+            exchange_start = MAX(now, 1);
+            break;
+        case EVENT_COAP_OK:
+            if(exchange_start != 0 && !timed_out)
+            {
+                sampleLocked((uint32_t)MIN(now - exchange_start, UINT32_MAX));
+            }
+            else if(exchange_start != 0)
+            {
+                stats.ambiguous++;
+            }
+            exchange_start = 0;
+            break;
+        case EVENT_COAP_NOACK:
+            stats.timeouts++;
+            timed_out      = true;
+            exchange_start = 0;
+            // Back off from the wait that just expired
+            if(stats.rto_ms != 0)
+            {
+                stats.rto_ms = boundRto(stats.rto_ms * 2);
+            }
+            break;
+        case EVENT_COAP_FAIL:
+            exchange_start = 0;
+            break;
+        case EVENT_UL_START:
+        case EVENT_UL_DONE:
+        case EVENT_UL_MAX_RETRY:
+            timed_out = false;
+            break;
+        default:
+            break;
+    }
+    wait_s      = waitToSetLocked();
+    resets_seen = resets;
+    k_spin_unlock(&rto_lock, key);
+
+    if(wait_s == 0)
+    {
+        return;
+    }
+
+    // The library call is not made under the spinlock
+    current_s = getResponseWaitTimeout();
+
+    key   = k_spin_lock(&rto_lock);
+    apply = (resets == resets_seen);
+    if(apply && configured_wait_s == 0)
+    {
+        // Kept for coapRtoReset(), the wait before the first change
+        configured_wait_s = current_s;
+    }
+    k_spin_unlock(&rto_lock, key);
+
+    if(apply)
+    {
+        setResponseWaitTimeout(wait_s);
+    }
+}
+
+#if defined(CONFIG_LMTSDK_EVENT_SUBSCRIBE)
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_START, coapRtoOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_OK, coapRtoOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_NOACK, coapRtoOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_FAIL, coapRtoOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_START, coapRtoOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_DONE, coapRtoOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_MAX_RETRY, coapRtoOnEvent);
+#endif
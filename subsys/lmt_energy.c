@@ -0,0 +1,316 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_energy.h"
+#include "lmt_event_subscribe.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_LMTSDK_TAPE_PACKER)
+#include "lmt_tape_packer.h"
+#endif
+
+// The ledgers keep charge_uc in uA * ms, divided only when copied out, so the short
+// intervals between the events are not truncated one by one
+static EnergyLedger totals;
+static EnergyLedger uplink; // Uplink in progress
+static EnergyLedger last;   // Last finished uplink
+static bool uplink_open;
+static bool last_valid;
+
+static bool modem_on;
+static bool connected;
+static bool coap_open;
+static int64_t last_time; // Uptime of the last integration
+
+static struct k_spinlock energy_lock;
+
+static void addTime(EnergyLedger *p_ledger, uint32_t ms)
+{
+    if(modem_on || connected)
+    {
+        p_ledger->modem_on_ms += ms;
+        p_ledger->charge_uc +=
+            (uint64_t)ms * (connected ? ENERGY_CONNECTED_CURRENT_UA : ENERGY_IDLE_CURRENT_UA);
+    }
+    if(connected)
+    {
+        p_ledger->connected_ms += ms;
+    }
+    if(coap_open)
+    {
+        p_ledger->coap_ms += ms;
+    }
+}
+
+/**
+ * @brief Copies a ledger out with the charge in microcoulombs
+ *
+ * @param p_out pointer to the output ledger
+ * @param p_ledger pointer to the ledger with the charge in uA * ms
+ */
+static void copyOut(EnergyLedger *p_out, const EnergyLedger *p_ledger)
+{
+    *p_out           = *p_ledger;
+    p_out->charge_uc = p_ledger->charge_uc / MSEC_PER_SEC;
+}
+
+static void integrateLocked(void)
+{
+    int64_t now = k_uptime_get();
+    uint32_t ms = (uint32_t)(now - last_time);
+
+    last_time = now;
+    addTime(&totals, ms);
+    if(uplink_open)
+    {
+        addTime(&uplink, ms);
+    }
+}
+
+// Counts an event in the totals and in the uplink in progress
+#define COUNT_LOCKED(field)    \
+    do                         \
+    {                          \
+        totals.field++;        \
+        if(uplink_open)        \
+        {                      \
+            uplink.field++;    \
+        }                      \
+    } while(0)
+
+static void closeUplinkLocked(bool failed)
+{
+    if(!uplink_open)
+    {
+        return;
+    }
+
+    if(failed)
+    {
+        totals.failed++;
+        uplink.failed++;
+    }
+    last        = uplink;
+    last_valid  = true;
+    uplink_open = false;
+}
+
+void energyAddMeasurements(uint32_t count)
+{
+    k_spinlock_key_t key = k_spin_lock(&energy_lock);
+
+    totals.measurements += count;
+    if(uplink_open)
+    {
+        uplink.measurements += count;
+    }
+    k_spin_unlock(&energy_lock, key);
+}
+
+int energyGetLast(EnergyLedger *p_ledger)
+{
+    k_spinlock_key_t key;
+    int err = 0;
+
+    if(p_ledger == NULL)
+    {
+        return -EINVAL;
+    }
+
+    key = k_spin_lock(&energy_lock);
+    if(last_valid)
+    {
+        copyOut(p_ledger, &last);
+    }
+    else
+    {
+        err = -ENODATA;
+    }
+    k_spin_unlock(&energy_lock, key);
+
+    return err;
+}
+
+int energyGetTotals(EnergyLedger *p_ledger)
+{
+    k_spinlock_key_t key;
+
+    if(p_ledger == NULL)
+    {
+        return -EINVAL;
+    }
+
+    key = k_spin_lock(&energy_lock);
+    integrateLocked();
+    copyOut(p_ledger, &totals);
+    k_spin_unlock(&energy_lock, key);
+
+    return 0;
+}
+
+void energyReset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&energy_lock);
+
+    integrateLocked();
+    memset(&totals, 0, sizeof(totals));
+    memset(&uplink, 0, sizeof(uplink));
+    memset(&last, 0, sizeof(last));
+    uplink_open = false;
+    last_valid  = false;
+    k_spin_unlock(&energy_lock, key);
+}
+
+static int formatLedger(char *p_out, size_t size, const char *p_name,
+                        const EnergyLedger *p_ledger)
+{
+    return snprintk(p_out, size,
+                    "%s ul=%u fail=%u retry=%u pkt=%u ack=%u on=%u conn=%u coap=%u mC=%u "
+                    "conn/pkt=%u conn/meas=%u\n",
+                    p_name, p_ledger->uplinks, p_ledger->failed, p_ledger->retries,
+                    p_ledger->packets, p_ledger->acked, p_ledger->modem_on_ms,
+                    p_ledger->connected_ms, p_ledger->coap_ms,
+                    (uint32_t)(p_ledger->charge_uc / 1000),
+                    p_ledger->packets ? p_ledger->connected_ms / p_ledger->packets : 0,
+                    p_ledger->measurements ? p_ledger->connected_ms / p_ledger->measurements : 0);
+}
+
+int energyFormat(char *p_out, size_t size)
+{
+    EnergyLedger ledger;
+    size_t len;
+
+    if(p_out == NULL || size == 0)
+    {
+        return -EINVAL;
+    }
+
+    energyGetTotals(&ledger);
+    len = formatLedger(p_out, size, "total", &ledger);
+    if(len < size && energyGetLast(&ledger) == 0)
+    {
+        len += formatLedger(&p_out[len], size - len, "last", &ledger);
+    }
+
+    return MIN(len, size - 1);
+}
+
+int energyAddColumn(uint8_t i_tape, uint32_t period)
+{
+#if defined(CONFIG_LMTSDK_TAPE_PACKER)
+    int32_t tracks[MAX_TRACKS_COUNT] = {0};
+    EnergyLedger ledger;
+    int err;
+
+    err = energyGetLast(&ledger);
+    if(err)
+    {
+        return err;
+    }
+
+    tracks[0] = MIN(ledger.modem_on_ms, INT32_MAX);
+    tracks[1] = MIN(ledger.connected_ms, INT32_MAX);
+    tracks[2] = MIN(ledger.coap_ms, INT32_MAX);
+    tracks[3] = MIN(ledger.packets, INT32_MAX);
+    tracks[4] = MIN(ledger.retries, INT32_MAX);
+    tracks[5] = ledger.failed ? 1 : 0;
+    tracks[6] = MIN(ledger.charge_uc / 1000, INT32_MAX);
+
+    return tapeAddColumn(i_tape, period, tracks);
+#else
+    ARG_UNUSED(i_tape);
+    ARG_UNUSED(period);
+
+    return -ENOTSUP;
+#endif
+}
+
+void energyOnEvent(SomEvent event, void *p_data, int i_data)
+{
+    k_spinlock_key_t key;
+
+    ARG_UNUSED(p_data);
+    ARG_UNUSED(i_data);
+
+    key = k_spin_lock(&energy_lock);
+    integrateLocked();
+
+    switch(event)
+    {
+        case EVENT_MODEM_ON:
+            modem_on = true;
+            break;
+        case EVENT_MODEM_OFF:
+            modem_on  = false;
+            connected = false;
+            coap_open = false;
+            break;
+        case EVENT_RRC_CONNECTED:
+            connected = true;
+            break;
+        case EVENT_RRC_IDLE:
+            connected = false;
+            break;
+        case EVENT_COAP_START:
+            coap_open = true;
+            COUNT_LOCKED(packets);
+            break;
+        case EVENT_COAP_OK:
+            coap_open = false;
+            COUNT_LOCKED(acked);
+            break;
+        case EVENT_COAP_NOACK:
+        case EVENT_COAP_FAIL:
+            coap_open = false;
+            break;
+        case EVENT_UL_START:
+            // A start without an end does not count as failed
+            memset(&uplink, 0, sizeof(uplink));
+            uplink_open = true;
+            COUNT_LOCKED(uplinks);
+            break;
+        case EVENT_UL_RETRY:
+            COUNT_LOCKED(retries);
+            break;
+        case EVENT_UL_DONE:
+            closeUplinkLocked(false);
+            break;
+        case EVENT_UL_MAX_RETRY:
+            closeUplinkLocked(true);
+            break;
+        default:
+            break;
+    }
+
+    k_spin_unlock(&energy_lock, key);
+}
+
+#if defined(CONFIG_LMTSDK_EVENT_SUBSCRIBE)
+SOM_EVENT_SUBSCRIBE(EVENT_MODEM_ON, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_MODEM_OFF, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_RRC_CONNECTED, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_RRC_IDLE, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_START, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_OK, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_NOACK, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_FAIL, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_START, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_RETRY, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_DONE, energyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_MAX_RETRY, energyOnEvent);
+#endif
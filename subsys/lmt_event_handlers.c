@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_event_subscribe.h"
+#include <stddef.h>
+#include <zephyr/toolchain.h>
+
+// The callbacks are weak in the library, an unlinked one is NULL
+void onDeviceInitOk(void *p_data, int i_data) __weak;
+void onLoggerInitOk(void *p_data, int i_data) __weak;
+void onPackerInitOk(void *p_data, int i_data) __weak;
+void onMailerInitOk(void *p_data, int i_data) __weak;
+void onDroppingOldest(void *p_data, int i_data) __weak;
+void onPackerStarted(void *p_data, int i_data) __weak;
+void onPackingFailed(void *p_data, int i_data) __weak;
+void onEnqueueFailed(void *p_data, int i_data) __weak;
+void onPackerDoneOk(void *p_data, int i_data) __weak;
+void onUlStart(void *p_data, int i_data) __weak;
+void onUlMaxRetry(void *p_data, int i_data) __weak;
+void onUlRetry(void *p_data, int i_data) __weak;
+void onUlDone(void *p_data, int i_data) __weak;
+void onRRCIdle(void *p_data, int i_data) __weak;
+void onRRCConnected(void *p_data, int i_data) __weak;
+void onNetworkUp(void *p_data, int i_data) __weak;
+void onNetworkDown(void *p_data, int i_data) __weak;
+void onModemOn(void *p_data, int i_data) __weak;
+void onModemOff(void *p_data, int i_data) __weak;
+void onCoapStart(void *p_data, int i_data) __weak;
+void onCoapFail(void *p_data, int i_data) __weak;
+void onCoapNoack(void *p_data, int i_data) __weak;
+void onCoapOk(void *p_data, int i_data) __weak;
+void onLogError(void *p_data, int i_data) __weak;
+void onLogWarning(void *p_data, int i_data) __weak;
+void onLogInfo(void *p_data, int i_data) __weak;
+void onTerminalCmd(void *p_data, int i_data) __weak;
+
+static const EventHandler handlers[EVENT_COUNT] = {
+    [EVENT_DEVICE_INIT_OK] = onDeviceInitOk,   [EVENT_LOGGER_INIT_OK] = onLoggerInitOk,
+    [EVENT_PACKER_INIT_OK] = onPackerInitOk,   [EVENT_MAILER_INIT_OK] = onMailerInitOk,
+    [EVENT_DROPPING_OLDEST] = onDroppingOldest, [EVENT_PACKER_STARTED] = onPackerStarted,
+    [EVENT_PACKING_FAILED] = onPackingFailed,  [EVENT_ENQUEUE_FAILED] = onEnqueueFailed,
+    [EVENT_PACKER_DONE_OK] = onPackerDoneOk,   [EVENT_UL_START] = onUlStart,
+    [EVENT_UL_MAX_RETRY] = onUlMaxRetry,       [EVENT_UL_RETRY] = onUlRetry,
+    [EVENT_UL_DONE] = onUlDone,                [EVENT_RRC_IDLE] = onRRCIdle,
+    [EVENT_RRC_CONNECTED] = onRRCConnected,    [EVENT_NETWORK_UP] = onNetworkUp,
+    [EVENT_NETWORK_DOWN] = onNetworkDown,      [EVENT_MODEM_ON] = onModemOn,
+    [EVENT_MODEM_OFF] = onModemOff,            [EVENT_COAP_START] = onCoapStart,
+    [EVENT_COAP_FAIL] = onCoapFail,            [EVENT_COAP_NOACK] = onCoapNoack,
+    [EVENT_COAP_OK] = onCoapOk,                [EVENT_LOG_ERROR] = onLogError,
+    [EVENT_LOG_WARNING] = onLogWarning,        [EVENT_LOG_INFO] = onLogInfo,
+    [EVENT_TERMINAL_CMD] = onTerminalCmd,
+};
+
+// The table is written by hand, a new event of SomEvent has to get its callback above
+BUILD_ASSERT(EVENT_TERMINAL_CMD == 26 && EVENT_COUNT == 27, "Add the new event to handlers");
+
+void somEventCallHandler(SomEvent event, void *p_data, int i_data)
+{
+    EventHandler handler;
+
+    if(event >= EVENT_COUNT)
+    {
+        return;
+    }
+
+    handler = handlers[event];
+    if(handler != NULL)
+    {
+        handler(p_data, i_data);
+    }
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_event_queue.h"
+#include "lmt_event_subscribe.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+typedef struct
+{
+    SomEvent event;
+    int i_data;
+    bool has_data;   // data holds a copy of i_data bytes of p_data
+    int64_t posted;  // Uptime ticks of the first post
+    char data[EVENT_QUEUE_DATA_SIZE + 1];
+} EventRecord;
+
+static uint8_t dispatch_modes[EVENT_COUNT] = {
+    [EVENT_UL_RETRY] = EVENT_DISPATCH_COALESCED,
+};
+
+// State events, a bypassing event drops the pending records of its opposite
+static const SomEvent state_pairs[][2] = {
+    {EVENT_NETWORK_UP, EVENT_NETWORK_DOWN},
+    {EVENT_RRC_IDLE, EVENT_RRC_CONNECTED},
+    {EVENT_MODEM_ON, EVENT_MODEM_OFF},
+};
+
+// Events whose p_data points to i_data bytes, the only data a queued event can copy
+static const bool sized_data[EVENT_COUNT] = {
+    [EVENT_TERMINAL_CMD] = true,
+};
+
+static EventRecord records[EVENT_QUEUE_LENGTH];
+static size_t i_head; // Oldest pending record
+static EventQueueStats stats;
+
+static struct k_spinlock queue_lock;
+// Held for every delivery, so a direct event waits for the callback in progress
+static K_MUTEX_DEFINE(deliver_mutex);
+
+static struct k_work_q event_work_q;
+static K_THREAD_STACK_DEFINE(event_stack, CONFIG_LMTSDK_EVENT_QUEUE_STACK_SIZE);
+
+static void dispatchWork(struct k_work *p_work);
+static K_WORK_DEFINE(dispatch_work, dispatchWork);
+
+static int eventQueueInit(void)
+{
+    struct k_work_queue_config config = {.name = "lmt_events"};
+
+    k_work_queue_init(&event_work_q);
+    k_work_queue_start(&event_work_q, event_stack, K_THREAD_STACK_SIZEOF(event_stack),
+                       CONFIG_LMTSDK_EVENT_QUEUE_PRIORITY, &config);
+
+    return 0;
+}
+
+SYS_INIT(eventQueueInit, APPLICATION, 0);
+
+/**
+ * @brief Finds the record a coalesced event merges into
+ *
+ * @param event The event type
+ * @return the newest pending record if it is of the same event, else NULL
+ */
+static EventRecord *findNewestLocked(SomEvent event)
+{
+    EventRecord *p_record;
+
+    if(stats.depth == 0)
+    {
+        return NULL;
+    }
+
+    // Merging into an older record would deliver it ahead of the events posted after it
+    p_record = &records[(i_head + stats.depth - 1) % EVENT_QUEUE_LENGTH];
+
+    return (p_record->event == event) ? p_record : NULL;
+}
+
+/**
+ * @brief Queues the event or merges it into the newest pending record of the same event
+ *
+ * @return true if queued, false if the event has to be delivered directly
+ */
+static bool queueLocked(SomEvent event, void *p_data, int i_data)
+{
+    EventRecord *p_record = NULL;
+    bool has_data         = (p_data != NULL);
+
+    // Data of an unknown size can not outlive the post
+    if(has_data && !sized_data[event])
+    {
+        return false;
+    }
+
+    if(has_data && (i_data <= 0 || i_data > EVENT_QUEUE_DATA_SIZE))
+    {
+        stats.overflows++;
+        return false;
+    }
+
+    if(dispatch_modes[event] == EVENT_DISPATCH_COALESCED)
+    {
+        p_record = findNewestLocked(event);
+    }
+
+    if(p_record != NULL)
+    {
+        stats.coalesced++;
+    }
+    else if(stats.depth >= EVENT_QUEUE_LENGTH)
+    {
+        stats.overflows++;
+        return false;
+    }
+    else
+    {
+        p_record         = &records[(i_head + stats.depth) % EVENT_QUEUE_LENGTH];
+        p_record->event  = event;
+        p_record->posted = k_uptime_ticks();
+        stats.depth++;
+        stats.max_depth = MAX(stats.max_depth, stats.depth);
+    }
+
+    // A coalesced record keeps its first post time and takes the latest data
+    p_record->i_data   = i_data;
+    p_record->has_data = has_data;
+    if(has_data)
+    {
+        memcpy(p_record->data, p_data, i_data);
+        p_record->data[i_data] = '\0';
+    }
+
+    return true;
+}
+
+/**
+ * @brief Drops the pending records of the opposite state of an event delivered ahead of
+ * them, e.g. a queued EVENT_NETWORK_UP when EVENT_NETWORK_DOWN is delivered directly,
+ * so the stale state does not arrive after it
+ *
+ * @param event The event delivered directly
+ */
+static void dropSupersededLocked(SomEvent event)
+{
+    SomEvent opposite = EVENT_COUNT;
+    uint32_t kept     = 0;
+
+    for(size_t i = 0; i < ARRAY_SIZE(state_pairs); i++)
+    {
+        if(state_pairs[i][0] == event)
+        {
+            opposite = state_pairs[i][1];
+        }
+        else if(state_pairs[i][1] == event)
+        {
+            opposite = state_pairs[i][0];
+        }
+    }
+
+    if(opposite == EVENT_COUNT)
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < stats.depth; i++)
+    {
+        EventRecord *p_record = &records[(i_head + i) % EVENT_QUEUE_LENGTH];
+
+        if(p_record->event == opposite)
+        {
+            continue;
+        }
+        if(kept != i)
+        {
+            records[(i_head + kept) % EVENT_QUEUE_LENGTH] = *p_record;
+        }
+        kept++;
+    }
+
+    stats.superseded += stats.depth - kept;
+    stats.depth       = kept;
+}
+
+static bool popRecord(EventRecord *p_record)
+{
+    k_spinlock_key_t key = k_spin_lock(&queue_lock);
+    uint32_t latency_us;
+
+    if(stats.depth == 0)
+    {
+        k_spin_unlock(&queue_lock, key);
+        return false;
+    }
+
+    *p_record = records[i_head];
+    i_head    = (i_head + 1) % EVENT_QUEUE_LENGTH;
+    stats.depth--;
+    stats.queued++;
+
+    latency_us = MIN(k_ticks_to_us_floor64(k_uptime_ticks() - p_record->posted), UINT32_MAX);
+    stats.total_latency_us += latency_us;
+    stats.max_latency_us    = MAX(stats.max_latency_us, latency_us);
+    k_spin_unlock(&queue_lock, key);
+
+    return true;
+}
+
+static void dispatchWork(struct k_work *p_work)
+{
+    // Only the dispatch thread uses it, kept off the stack
+    static EventRecord record;
+
+    ARG_UNUSED(p_work);
+
+    while(true)
+    {
+        k_mutex_lock(&deliver_mutex, K_FOREVER);
+        if(!popRecord(&record))
+        {
+            k_mutex_unlock(&deliver_mutex);
+            break;
+        }
+        somEventCallHandler(record.event, record.has_data ? record.data : NULL, record.i_data);
+        k_mutex_unlock(&deliver_mutex);
+    }
+}
+
+int eventQueueSetDispatch(SomEvent event, EventDispatch dispatch)
+{
+    k_spinlock_key_t key;
+
+    if(event >= EVENT_COUNT || dispatch > EVENT_DISPATCH_DIRECT)
+    {
+        return -EINVAL;
+    }
+
+    key                   = k_spin_lock(&queue_lock);
+    dispatch_modes[event] = dispatch;
+    k_spin_unlock(&queue_lock, key);
+
+    return 0;
+}
+
+void eventQueuePost(SomEvent event, void *p_data, int i_data)
+{
+    k_spinlock_key_t key;
+    bool queued;
+
+    if(event >= EVENT_COUNT)
+    {
+        return;
+    }
+
+    key = k_spin_lock(&queue_lock);
+    stats.posted++;
+    queued = (dispatch_modes[event] != EVENT_DISPATCH_DIRECT) && queueLocked(event, p_data, i_data);
+    if(!queued)
+    {
+        stats.direct++;
+        dropSupersededLocked(event);
+    }
+    k_spin_unlock(&queue_lock, key);
+
+    if(queued)
+    {
+        k_work_submit_to_queue(&event_work_q, &dispatch_work);
+    }
+    else
+    {
+        k_mutex_lock(&deliver_mutex, K_FOREVER);
+        somEventCallHandler(event, p_data, i_data);
+        k_mutex_unlock(&deliver_mutex);
+    }
+}
+
+int eventQueueGetStats(EventQueueStats *p_stats)
+{
+    k_spinlock_key_t key;
+
+    if(p_stats == NULL)
+    {
+        return -EINVAL;
+    }
+
+    key      = k_spin_lock(&queue_lock);
+    *p_stats = stats;
+    k_spin_unlock(&queue_lock, key);
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_event_subscribe.h"
+#include "lmt_event_queue.h"
+#include <stdbool.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+// Subscribers of each event, slot EVENT_COUNT for the subscribers of every event
+static const SomEventSubscriber *first[EVENT_COUNT + 1];
+static uint16_t counts[EVENT_COUNT + 1];
+// Set if the linker did not group the section, then every call scans it
+static bool unsorted;
+
+static int eventSubscribeInit(void)
+{
+    STRUCT_SECTION_FOREACH(SomEventSubscriber, p_subscriber)
+    {
+        SomEvent slot = MIN(p_subscriber->event, EVENT_COUNT);
+
+        if(counts[slot] == 0)
+        {
+            first[slot] = p_subscriber;
+        }
+        else if(first[slot] + counts[slot] != p_subscriber)
+        {
+            unsorted = true;
+        }
+        counts[slot]++;
+    }
+
+    return 0;
+}
+
+// Before any thread that could raise an event
+SYS_INIT(eventSubscribeInit, PRE_KERNEL_1, 0);
+
+static void callSubscribers(SomEvent slot, SomEvent event, void *p_data, int i_data)
+{
+    if(unsorted)
+    {
+        STRUCT_SECTION_FOREACH(SomEventSubscriber, p_subscriber)
+        {
+            if(MIN(p_subscriber->event, EVENT_COUNT) == slot)
+            {
+                p_subscriber->callback(event, p_data, i_data);
+            }
+        }
+        return;
+    }
+
+    for(uint16_t i = 0; i < counts[slot]; i++)
+    {
+        first[slot][i].callback(event, p_data, i_data);
+    }
+}
+
+void somEventPublish(SomEvent event, void *p_data, int i_data)
+{
+    if(event >= EVENT_COUNT)
+    {
+        return;
+    }
+
+    callSubscribers(event, event, p_data, i_data);
+    callSubscribers(EVENT_COUNT, event, p_data, i_data);
+
+    if(IS_ENABLED(CONFIG_LMTSDK_EVENT_QUEUE))
+    {
+        eventQueuePost(event, p_data, i_data);
+    }
+    else
+    {
+        somEventCallHandler(event, p_data, i_data);
+    }
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_host_shim.h"
+#include "lmt_coap_manager.h"
+#include "lmt_filesystem.h"
+#include "lmt_settings.h"
+#include "lmt_som_event_emitter.h"
+#include <date_time.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+
+#define HOST_SHIM_LOG_FILE_MAX_SIZE (64 * 1024)
+#define HOST_SHIM_LOG_FILE_COUNT    8
+#define HOST_SHIM_LOG_LEVEL         LOG_INFORMATIVE
+#define HOST_SHIM_UL_DATA_MODE      1 // Raw data mode
+// 2026-01-01 00:00:00 UTC, the time the uptime counts from without CONFIG_DATE_TIME
+#define HOST_SHIM_EPOCH_MS          1767225600000LL
+
+static uint8_t *p_pending; // Raw data handed over with setRawData()
+static uint16_t pending_len;
+static size_t sent_bytes;
+static uint32_t mailer_triggers;
+static MailerWaitModes mailer_wait_mode;
+// Cached quality of getNetworkQuality(), not valid until set
+static bool quality_valid;
+static int32_t network_rsrp;
+static int32_t network_rsrq;
+static int32_t network_snr;
+
+static K_MUTEX_DEFINE(shim_mutex);
+
+#if defined(CONFIG_LMTSDK_HOST_FS)
+
+#define MOUNT_POINT DT_PROP(DT_NODELABEL(lfs1), mount_point)
+#define PATH_SIZE   64
+
+static void makePath(char *p_path, size_t size, const char *filename)
+{
+    snprintk(p_path, size, "%s/%s", MOUNT_POINT, filename);
+}
+
+int fileOverwrite(const char *filename, char *text)
+{
+    char path[PATH_SIZE];
+    struct fs_file_t file;
+    ssize_t written;
+    int err;
+
+    makePath(path, sizeof(path), filename);
+    fs_file_t_init(&file);
+    err = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE);
+    if(err)
+    {
+        return err;
+    }
+
+    err = fs_truncate(&file, 0);
+    if(!err)
+    {
+        written = fs_write(&file, text, strlen(text));
+        err     = (written < 0) ? (int)written : 0;
+    }
+    fs_close(&file);
+
+    return err ? err : (int)strlen(text);
+}
+
+int fileRead(const char *filename, char *read_buffer, size_t buffer_size, size_t offset,
+             size_t file_size)
+{
+    char path[PATH_SIZE];
+    struct fs_file_t file;
+    ssize_t len;
+    int err;
+
+    if(offset >= file_size)
+    {
+        return 0;
+    }
+
+    makePath(path, sizeof(path), filename);
+    fs_file_t_init(&file);
+    err = fs_open(&file, path, FS_O_READ);
+    if(err)
+    {
+        return err;
+    }
+
+    err = fs_seek(&file, offset, FS_SEEK_SET);
+    len = err ? err : fs_read(&file, read_buffer, MIN(buffer_size, file_size - offset));
+    fs_close(&file);
+
+    return (int)len;
+}
+
+int getFileSize(const char *filename)
+{
+    char path[PATH_SIZE];
+    struct fs_dirent entry;
+    int err;
+
+    makePath(path, sizeof(path), filename);
+    err = fs_stat(path, &entry);
+
+    return err ? err : (int)entry.size;
+}
+
+int deleteFile(const char *filename)
+{
+    char path[PATH_SIZE];
+
+    makePath(path, sizeof(path), filename);
+
+    return fs_unlink(path);
+}
+
+#endif // CONFIG_LMTSDK_HOST_FS
+
+int setRawData(uint8_t *raw_data, uint16_t raw_data_len, bool upload)
+{
+    ARG_UNUSED(upload);
+
+    k_mutex_lock(&shim_mutex, K_FOREVER);
+    p_pending   = raw_data;
+    pending_len = raw_data_len;
+    k_mutex_unlock(&shim_mutex);
+
+    return 0;
+}
+
+int cleanRawData(void)
+{
+    return setRawData(NULL, 0, false);
+}
+
+int hostShimPack(void)
+{
+    int len;
+
+    k_mutex_lock(&shim_mutex, K_FOREVER);
+    len         = (p_pending != NULL) ? pending_len : -ENODATA;
+    p_pending   = NULL;
+    pending_len = 0;
+    k_mutex_unlock(&shim_mutex);
+
+    if(len >= 0)
+    {
+        // The packer copies the raw data into the CoAP queue before it reports
+        handleSomEvent(EVENT_PACKER_STARTED, NULL, 0);
+        handleSomEvent(EVENT_PACKER_DONE_OK, NULL, 0);
+    }
+
+    return len;
+}
+
+void triggerMailer(bool trigger_radio_pata_packing)
+{
+    ARG_UNUSED(trigger_radio_pata_packing);
+
+    k_mutex_lock(&shim_mutex, K_FOREVER);
+    mailer_triggers++;
+    k_mutex_unlock(&shim_mutex);
+}
+
+uint32_t hostShimGetMailerTriggers(void)
+{
+    return mailer_triggers;
+}
+
+MailerWaitModes getMailerWaitMode(void)
+{
+    return mailer_wait_mode;
+}
+
+void setMailerWaitMode(MailerWaitModes mode)
+{
+    mailer_wait_mode = mode;
+}
+
+int getNetworkQuality(int32_t *rsrp, int32_t *rsrq, int32_t *snr)
+{
+    int err = -EINVAL;
+
+    k_mutex_lock(&shim_mutex, K_FOREVER);
+    if(quality_valid)
+    {
+        *rsrp = network_rsrp;
+        *rsrq = network_rsrq;
+        *snr  = network_snr;
+        err   = 0;
+    }
+    k_mutex_unlock(&shim_mutex);
+
+    return err;
+}
+
+void hostShimSetNetworkQuality(int32_t rsrp, int32_t rsrq, int32_t snr)
+{
+    k_mutex_lock(&shim_mutex, K_FOREVER);
+    network_rsrp  = rsrp;
+    network_rsrq  = rsrq;
+    network_snr   = snr;
+    quality_valid = true;
+    k_mutex_unlock(&shim_mutex);
+}
+
+int sendFileChunk(const char *filename, const char *data_chunk, int size, int total_size)
+{
+    ARG_UNUSED(filename);
+    ARG_UNUSED(data_chunk);
+    ARG_UNUSED(total_size);
+
+    if(size < 0)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&shim_mutex, K_FOREVER);
+    sent_bytes += size;
+    k_mutex_unlock(&shim_mutex);
+
+    return 0;
+}
+
+size_t hostShimGetSentBytes(void)
+{
+    return sent_bytes;
+}
+
+int32_t getLogFileMaxSize(void)
+{
+    return HOST_SHIM_LOG_FILE_MAX_SIZE;
+}
+
+uint8_t getNumOfLogFiles(void)
+{
+    return HOST_SHIM_LOG_FILE_COUNT;
+}
+
+LogLevel getLogLevel(void)
+{
+    return HOST_SHIM_LOG_LEVEL;
+}
+
+uint8_t getUlDataMode(void)
+{
+    return HOST_SHIM_UL_DATA_MODE;
+}
+
+__weak void handleSomEvent(SomEvent event, void *p_data, int i_data)
+{
+    ARG_UNUSED(event);
+    ARG_UNUSED(p_data);
+    ARG_UNUSED(i_data);
+}
+
+#if !defined(CONFIG_DATE_TIME)
+int date_time_now(int64_t *unix_time_ms)
+{
+    *unix_time_ms = HOST_SHIM_EPOCH_MS + k_uptime_get();
+
+    return 0;
+}
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_latency.h"
+#include "lmt_event_subscribe.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/timing/timing.h>
+
+#if defined(CONFIG_LMTSDK_TAPE_PACKER)
+#include "lmt_tape_packer.h"
+#endif
+
+static const char *const probe_names[] = {
+    "tape_encode", "uplink_compress", "queue_handover", "spill_write",
+    "log_store_write", "packer", "coap", "uplink",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(probe_names) == LATENCY_PROBE_COUNT, "Name every probe");
+
+static LatencyHistogram histograms[LATENCY_PROBE_COUNT];
+// Uptime ticks of the open event spans, 0 when no span is open
+static int64_t span_starts[LATENCY_PROBE_COUNT];
+static int64_t reset_time;
+#if defined(CONFIG_LMTSDK_TAPE_PACKER)
+// Period of the latency columns in each Tape until the Tape is uploaded
+static uint32_t tape_periods[TAPE_COUNT];
+#endif
+
+static struct k_spinlock latency_lock;
+
+static int latencyInit(void)
+{
+    timing_init();
+    timing_start();
+
+    return 0;
+}
+
+SYS_INIT(latencyInit, APPLICATION, 0);
+
+static size_t bucketOf(uint32_t us)
+{
+    size_t i_bucket = 0;
+
+    while(i_bucket < (LATENCY_BUCKET_COUNT - 1) && us >= BIT(i_bucket))
+    {
+        i_bucket++;
+    }
+
+    return i_bucket;
+}
+
+void latencyRecord(LatencyProbe probe, uint32_t us)
+{
+    LatencyHistogram *p_histogram;
+    k_spinlock_key_t key;
+
+    if(probe >= LATENCY_PROBE_COUNT)
+    {
+        return;
+    }
+
+    p_histogram = &histograms[probe];
+    key         = k_spin_lock(&latency_lock);
+    p_histogram->count++;
+    p_histogram->total_us += us;
+    p_histogram->max_us    = MAX(p_histogram->max_us, us);
+    p_histogram->buckets[bucketOf(us)]++;
+    k_spin_unlock(&latency_lock, key);
+}
+
+void latencyStop(LatencyProbe probe, timing_t start)
+{
+    timing_t end    = timing_counter_get();
+    uint64_t cycles = timing_cycles_get(&start, &end);
+
+    latencyRecord(probe, MIN(timing_cycles_to_ns(cycles) / NSEC_PER_USEC, UINT32_MAX));
+}
+
+int latencyGet(LatencyProbe probe, LatencyHistogram *p_histogram)
+{
+    k_spinlock_key_t key;
+
+    if(probe >= LATENCY_PROBE_COUNT || p_histogram == NULL)
+    {
+        return -EINVAL;
+    }
+
+    key          = k_spin_lock(&latency_lock);
+    *p_histogram = histograms[probe];
+    k_spin_unlock(&latency_lock, key);
+
+    return 0;
+}
+
+uint32_t latencyPercentile(const LatencyHistogram *p_histogram, uint8_t percent)
+{
+    uint64_t rank;
+    uint64_t seen = 0;
+
+    if(p_histogram == NULL || p_histogram->count == 0)
+    {
+        return 0;
+    }
+
+    // The sample at the rank is the first one the bucket sums reach
+    rank = MAX(((uint64_t)p_histogram->count * MIN(percent, 100) + 99) / 100, 1);
+    for(size_t i = 0; i < (LATENCY_BUCKET_COUNT - 1); i++)
+    {
+        seen += p_histogram->buckets[i];
+        if(seen >= rank)
+        {
+            return MIN(BIT(i), p_histogram->max_us);
+        }
+    }
+
+    return p_histogram->max_us;
+}
+
+void latencyReset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+    memset(histograms, 0, sizeof(histograms));
+    reset_time = k_uptime_get();
+    k_spin_unlock(&latency_lock, key);
+}
+
+int latencyFormat(char *p_out, size_t size)
+{
+    size_t len = 0;
+
+    if(p_out == NULL || size == 0)
+    {
+        return -EINVAL;
+    }
+    p_out[0] = '\0';
+
+    for(size_t probe = 0; probe < LATENCY_PROBE_COUNT && len < size; probe++)
+    {
+        LatencyHistogram histogram;
+
+        latencyGet(probe, &histogram);
+        if(histogram.count == 0)
+        {
+            continue;
+        }
+
+        len += snprintk(&p_out[len], size - len, "%s n=%u avg=%u p50<=%u p99<=%u max=%u\n",
+                        probe_names[probe], histogram.count,
+                        (uint32_t)(histogram.total_us / histogram.count),
+                        latencyPercentile(&histogram, 50), latencyPercentile(&histogram, 99),
+                        histogram.max_us);
+    }
+
+    return MIN(len, size - 1);
+}
+
+int latencyAddColumns(uint8_t i_tape)
+{
+#if defined(CONFIG_LMTSDK_TAPE_PACKER)
+    int added = 0;
+
+    if(i_tape >= TAPE_COUNT)
+    {
+        return -EINVAL;
+    }
+
+    // Every new period takes one of the MAX_PERIODS_COUNT entries of the Tape, so all
+    // columns of one upload share the period taken when the Tape was empty
+    if(tapeGetRecordsCount(i_tape) == 0)
+    {
+        tape_periods[i_tape] = (k_uptime_get() - reset_time) / MSEC_PER_SEC;
+    }
+
+    for(size_t probe = 0; probe < LATENCY_PROBE_COUNT; probe++)
+    {
+        int32_t tracks[MAX_TRACKS_COUNT] = {0};
+        LatencyHistogram histogram;
+        int err;
+
+        latencyGet(probe, &histogram);
+        if(histogram.count == 0)
+        {
+            continue;
+        }
+
+        tracks[0] = probe;
+        tracks[1] = MIN(histogram.count, INT32_MAX);
+        tracks[2] = MIN(histogram.total_us / histogram.count, INT32_MAX);
+        tracks[3] = MIN(latencyPercentile(&histogram, 50), INT32_MAX);
+        tracks[4] = MIN(latencyPercentile(&histogram, 90), INT32_MAX);
+        tracks[5] = MIN(latencyPercentile(&histogram, 99), INT32_MAX);
+        tracks[6] = MIN(histogram.max_us, INT32_MAX);
+
+        err = tapeAddColumn(i_tape, tape_periods[i_tape], tracks);
+        if(err < 0)
+        {
+            return err;
+        }
+        added++;
+    }
+
+    return added;
+#else
+    ARG_UNUSED(i_tape);
+
+    return -ENOTSUP;
+#endif
+}
+
+static void spanStart(LatencyProbe probe)
+{
+    k_spinlock_key_t key = k_spin_lock(&latency_lock);
+
+    // Never 0, that marks no open span
+    span_starts[probe] = MAX(k_uptime_ticks(), 1);
+    k_spin_unlock(&latency_lock, key);
+}
+
+static void spanStop(LatencyProbe probe)
+{
+    k_spinlock_key_t key = k_spin_lock(&latency_lock);
+    int64_t start        = span_starts[probe];
+
+    span_starts[probe] = 0;
+    k_spin_unlock(&latency_lock, key);
+
+    if(start != 0)
+    {
+        latencyRecord(probe, MIN(k_ticks_to_us_floor64(k_uptime_ticks() - start), UINT32_MAX));
+    }
+}
+
+void latencyOnEvent(SomEvent event, void *p_data, int i_data)
+{
+    ARG_UNUSED(p_data);
+    ARG_UNUSED(i_data);
+
+    switch(event)
+    {
+        case EVENT_PACKER_STARTED:
+            spanStart(LATENCY_PACKER);
+            break;
+        case EVENT_PACKER_DONE_OK:
+        case EVENT_PACKING_FAILED:
+        case EVENT_ENQUEUE_FAILED:
+            spanStop(LATENCY_PACKER);
+            break;
+        case EVENT_COAP_START:
+            spanStart(LATENCY_COAP);
+            break;
+        case EVENT_COAP_OK:
+        case EVENT_COAP_NOACK:
+        case EVENT_COAP_FAIL:
+            spanStop(LATENCY_COAP);
+            break;
+        case EVENT_UL_START:
+            spanStart(LATENCY_UPLINK);
+            break;
+        case EVENT_UL_DONE:
+        case EVENT_UL_MAX_RETRY:
+            spanStop(LATENCY_UPLINK);
+            break;
+        default:
+            break;
+    }
+}
+
+#if defined(CONFIG_LMTSDK_EVENT_SUBSCRIBE)
+SOM_EVENT_SUBSCRIBE(EVENT_PACKER_STARTED, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_PACKER_DONE_OK, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_PACKING_FAILED, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_ENQUEUE_FAILED, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_START, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_OK, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_NOACK, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_FAIL, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_START, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_DONE, latencyOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_MAX_RETRY, latencyOnEvent);
+#endif
@@ -0,0 +1,1911 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_log_store.h"
+#include "lmt_coap_manager.h"
+#include "lmt_filesystem.h"
+#include "lmt_latency.h"
+#include "lmt_uplink_compress.h"
+#include <date_time.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/crc.h>
+
+#define MOUNT_POINT DT_PROP(DT_NODELABEL(lfs1), mount_point)
+#define FILE_PREFIX "log_"
+#define FILE_SUFFIX ".lz4"
+// Name for the lmt_filesystem.h API, relative to the mount point
+#define FILE_NAME_FORMAT FILE_PREFIX "%u" FILE_SUFFIX
+#define FILE_PATH_FORMAT MOUNT_POINT "/" FILE_NAME_FORMAT
+#define FILE_PATH_SIZE   32
+// Sequence numbers of the oldest, the next to upload and the current file, as text
+#define CATALOGUE_NAME      "logstore.cat"
+#define CATALOGUE_TEXT_SIZE 36
+// Upload name and scratch file of logStoreUploadRange()
+#define RANGE_NAME          FILE_PREFIX "range" FILE_SUFFIX
+#define RANGE_FILE_NAME     "logstore.rng"
+#define RANGE_PATH          MOUNT_POINT "/" RANGE_FILE_NAME
+
+#if defined(CONFIG_LMTSDK_LOG_STORE_PARTITION)
+#define LOG_STORE_PARTITION_ID FIXED_PARTITION_ID(log_store_partition)
+// A segment is a file of the file store
+#define FILE_HEAD_SIZE         sizeof(LogStoreSegmentHead)
+#define FILE_MAX_SIZE          LOG_STORE_SEGMENT_SIZE
+#else
+#define FILE_HEAD_SIZE 0
+#define FILE_MAX_SIZE  ((size_t)getLogFileMaxSize())
+#endif
+
+#define LOG_STORE_THREAD_STACK_SIZE 2048
+#define LOG_STORE_THREAD_PRIORITY   K_LOWEST_APPLICATION_THREAD_PRIO
+
+BUILD_ASSERT(IS_POWER_OF_TWO(LOG_STORE_QUEUE_LENGTH), "The uint32_t queue positions wrap at 2^32");
+BUILD_ASSERT(LOG_STORE_RECORD_SIZE <= LOG_STORE_BLOCK_SIZE, "A record has to fit a block");
+#if defined(CONFIG_LMTSDK_LOG_STORE_PARTITION)
+BUILD_ASSERT(LOG_STORE_SEGMENT_SIZE % LOG_STORE_PAGE_SIZE == 0, "Pages must not cross segments");
+BUILD_ASSERT(sizeof(LogStoreSegmentHead) + sizeof(LogStoreBlockHead) + LOG_STORE_BLOCK_SIZE <=
+                 LOG_STORE_SEGMENT_SIZE,
+             "A block has to fit a segment");
+BUILD_ASSERT(IS_POWER_OF_TWO(FIXED_PARTITION_SIZE(log_store_partition) / LOG_STORE_SEGMENT_SIZE),
+             "The segment of a sequence number must not jump when it wraps at 2^32");
+#endif
+
+/*
+ * Bounded lock-free queue between the log callers and the store thread, one slot per
+ * record. seq tells the state of the slot for the queue position p it serves in the
+ * current lap: p when free, p + 1 when the record is published. A producer claims p
+ * with a CAS on head, the consumer frees the slot for p + LOG_STORE_QUEUE_LENGTH.
+ * The positions and seq are uint32_t kept in atomic_t, they wrap at 2^32 and are
+ * compared by their signed difference.
+ */
+typedef struct
+{
+    atomic_t seq;
+    int64_t timestamp;
+    uint8_t level;
+    uint16_t len;
+    uint8_t data[LOG_STORE_RECORD_SIZE];
+} LogStoreSlot;
+
+static bool opened;           // Store found after boot
+static uint32_t oldest_seq;   // Oldest file not deleted yet
+static uint32_t upload_seq;   // Oldest file not uploaded yet
+static uint32_t current_seq;  // File the blocks are appended to
+static size_t current_size;   // Size of the current file
+static char block[LOG_STORE_BLOCK_SIZE];
+static size_t block_len;
+static uint16_t block_records;
+static uint8_t block_levels;  // Bit per LogLevel of the records
+static int64_t block_first;   // Timestamps of the first and the last record
+static int64_t block_last;
+// Compressed block, kept only when it is smaller than the text
+static uint8_t compressed[LOG_STORE_BLOCK_SIZE];
+// Blocks waiting for the next page boundary of the current file
+static uint8_t page[LOG_STORE_PAGE_SIZE];
+static size_t page_len;
+
+static LogStoreSlot slots[LOG_STORE_QUEUE_LENGTH];
+static atomic_t head;      // Next position of the producers
+static uint32_t tail;      // Next position of the consumer, under store_mutex
+static atomic_t dropped;   // Records lost to a full queue since boot
+static atomic_t flush_due; // Set by an error record or the flush timer
+
+static K_MUTEX_DEFINE(store_mutex);
+static K_SEM_DEFINE(queue_sem, 0, 1);
+
+static const char level_letters[] = {'E', 'W', 'I'};
+
+#if defined(CONFIG_LMTSDK_LOG_STORE_PARTITION)
+
+static const struct flash_area *p_area;
+static uint32_t segment_count;
+
+// The segment of a sequence number is fixed, so no table is needed to find it
+static off_t segmentOffset(uint32_t seq)
+{
+    return (off_t)(seq & (segment_count - 1)) * LOG_STORE_SEGMENT_SIZE;
+}
+
+/**
+ * @brief Reads the head of a segment
+ *
+ * @param offset the offset of the segment in the partition
+ * @param p_head pointer to the head
+ * @return true if the segment holds a valid head
+ */
+static bool readSegmentHead(off_t offset, LogStoreSegmentHead *p_head)
+{
+    if(flash_area_read(p_area, offset, p_head, sizeof(*p_head)))
+    {
+        return false;
+    }
+
+    return p_head->magic == LOG_STORE_SEGMENT_MAGIC &&
+           p_head->crc ==
+               crc32_ieee((const uint8_t *)p_head, offsetof(LogStoreSegmentHead, crc));
+}
+
+static bool readSegmentHeadOf(uint32_t seq, LogStoreSegmentHead *p_head)
+{
+    return readSegmentHead(segmentOffset(seq), p_head) && p_head->seq == seq;
+}
+
+/**
+ * @brief Erases a page of the current segment, unless it is past the segment end
+ *
+ * @return 0 on success, negative errno code of the flash driver on fail
+ */
+static int erasePageLocked(size_t index)
+{
+    if((index + 1) * LOG_STORE_PAGE_SIZE > LOG_STORE_SEGMENT_SIZE)
+    {
+        return 0;
+    }
+
+    return flash_area_erase(p_area, segmentOffset(current_seq) + index * LOG_STORE_PAGE_SIZE,
+                            LOG_STORE_PAGE_SIZE);
+}
+
+/**
+ * @brief Starts the next segment, the oldest segment is overwritten once the partition
+ * is full. The page buffer has to be written before.
+ */
+static void rotateLocked(void)
+{
+    LogStoreSegmentHead head = {.magic    = LOG_STORE_SEGMENT_MAGIC,
+                                .uploaded = LOG_STORE_SEGMENT_NOT_UPLOADED};
+
+    current_seq++;
+    current_size = FILE_HEAD_SIZE;
+
+    if((current_seq - oldest_seq) >= segment_count)
+    {
+        oldest_seq = current_seq - segment_count + 1;
+    }
+
+    if((upload_seq - oldest_seq) > (current_seq - oldest_seq))
+    {
+        // Overwritten before it was uploaded
+        upload_seq = oldest_seq;
+    }
+
+    head.seq = current_seq;
+    head.crc = crc32_ieee((const uint8_t *)&head, offsetof(LogStoreSegmentHead, crc));
+
+    // A segment left without a head is skipped by the boot and the upload
+    if(erasePageLocked(0) == 0)
+    {
+        flash_area_write(p_area, segmentOffset(current_seq), &head, sizeof(head));
+    }
+}
+
+/**
+ * @brief Finds the newest segment from the segment heads, the new segment follows it
+ *
+ * @return 0 on success, -ENOTSUP if the flash does not program single bytes, negative
+ * errno code of the flash driver on fail
+ */
+static int openLocked(void)
+{
+    LogStoreSegmentHead head;
+    uint16_t magic;
+    bool found  = false;
+    bool marked = false;
+    int err;
+
+    if(opened)
+    {
+        return 0;
+    }
+
+    err = flash_area_open(LOG_STORE_PARTITION_ID, &p_area);
+    if(err)
+    {
+        return err;
+    }
+
+    // Blocks are appended at any byte offset
+    if(flash_area_align(p_area) != 1)
+    {
+        flash_area_close(p_area);
+        return -ENOTSUP;
+    }
+    segment_count = p_area->fa_size / LOG_STORE_SEGMENT_SIZE;
+
+    for(uint32_t i = 0; i < segment_count; i++)
+    {
+        if(!readSegmentHead((off_t)i * LOG_STORE_SEGMENT_SIZE, &head) ||
+           (head.seq % segment_count) != i)
+        {
+            continue;
+        }
+
+        if(!found || (int32_t)(head.seq - current_seq) > 0)
+        {
+            current_seq = head.seq;
+        }
+        found = true;
+    }
+
+    opened = true;
+    if(!found)
+    {
+        // Empty partition, the rotation starts segment 0
+        current_seq = -1;
+        oldest_seq  = 0;
+        upload_seq  = 0;
+        rotateLocked();
+        return 0;
+    }
+
+    // Back from the newest segment to the first gap, the upload marks are set in order
+    oldest_seq = current_seq;
+    upload_seq = current_seq;
+    for(uint32_t seq = current_seq; (current_seq - seq) < segment_count; seq--)
+    {
+        if(!readSegmentHeadOf(seq, &head))
+        {
+            break;
+        }
+        oldest_seq  = seq;
+        marked     |= head.uploaded != LOG_STORE_SEGMENT_NOT_UPLOADED;
+        if(!marked)
+        {
+            upload_seq = seq;
+        }
+    }
+
+    // Every boot starts a new segment, an empty one is kept
+    current_size = FILE_HEAD_SIZE;
+    if(flash_area_read(p_area, segmentOffset(current_seq) + FILE_HEAD_SIZE, &magic,
+                       sizeof(magic)) ||
+       magic != 0xFFFF)
+    {
+        rotateLocked();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Programs the page buffer. The first write to a page erases the next one, so the
+ * blocks always end at an erased head and one page erase at a time stalls the writes.
+ *
+ * @return 0 on success, negative errno code of the flash driver on fail
+ */
+static int writeLocked(const void *p_data, size_t len)
+{
+    int err = 0;
+
+    if((current_size % LOG_STORE_PAGE_SIZE) == 0 || current_size == FILE_HEAD_SIZE)
+    {
+        err = erasePageLocked(current_size / LOG_STORE_PAGE_SIZE + 1);
+    }
+
+    return err ? err
+               : flash_area_write(p_area, segmentOffset(current_seq) + current_size, p_data,
+                                  len);
+}
+
+/**
+ * @brief Marks a segment uploaded, the mark is programmed over the erased word of the
+ * head without an erase
+ *
+ * @param seq the sequence number of the segment
+ */
+static void markUploadedLocked(uint32_t seq)
+{
+    uint32_t mark = 0;
+
+    if((seq - oldest_seq) < (current_seq - oldest_seq))
+    {
+        flash_area_write(p_area, segmentOffset(seq) + offsetof(LogStoreSegmentHead, uploaded),
+                         &mark, sizeof(mark));
+    }
+
+    if(upload_seq == seq)
+    {
+        upload_seq++;
+    }
+}
+
+/**
+ * @brief Reads a part of a segment, unless the rotation has overwritten it
+ *
+ * @param seq the sequence number of the segment
+ * @param offset the offset in the segment
+ * @param p_data pointer to the buffer
+ * @param len the length to read
+ * @return 0 on success, -ENOENT if the segment is gone, -ENODATA past the segment end,
+ * negative errno code on fail
+ */
+static int readFile(uint32_t seq, size_t offset, void *p_data, size_t len)
+{
+    int err = -ENOENT;
+
+    if((offset + len) > LOG_STORE_SEGMENT_SIZE)
+    {
+        return -ENODATA;
+    }
+
+    k_mutex_lock(&store_mutex, K_FOREVER);
+    if((seq - oldest_seq) <= (current_seq - oldest_seq))
+    {
+        err = flash_area_read(p_area, segmentOffset(seq) + offset, p_data, len);
+    }
+    k_mutex_unlock(&store_mutex);
+
+    return err;
+}
+
+/**
+ * @brief Sends the blocks of one segment with sendFileChunk(), as log_<seq>.lz4
+ *
+ * @param seq the sequence number of the segment
+ * @return 0 on success, -ENOENT if the segment is gone, negative error code on fail
+ */
+static int uploadFile(uint32_t seq)
+{
+    static char chunk[LOG_STORE_UPLOAD_CHUNK_SIZE];
+    char name[FILE_PATH_SIZE];
+    LogStoreSegmentHead segment;
+    LogStoreBlockHead head;
+    size_t end = FILE_HEAD_SIZE;
+    int err;
+
+    k_mutex_lock(&store_mutex, K_FOREVER);
+    err = readSegmentHeadOf(seq, &segment) ? 0 : -ENOENT;
+    k_mutex_unlock(&store_mutex);
+
+    // The blocks end at the first erased head
+    while(!err && (end + sizeof(head)) <= LOG_STORE_SEGMENT_SIZE)
+    {
+        err = readFile(seq, end, &head, sizeof(head));
+        if(err || (head.magic != LOG_STORE_BLOCK_MAGIC &&
+                   head.magic != LOG_STORE_DICTIONARY_BLOCK_MAGIC))
+        {
+            break;
+        }
+        end = MIN(end + sizeof(head) + head.len, LOG_STORE_SEGMENT_SIZE);
+    }
+
+    snprintk(name, sizeof(name), FILE_NAME_FORMAT, (unsigned int)seq);
+    for(size_t sent = 0; !err && sent < (end - FILE_HEAD_SIZE);)
+    {
+        size_t len = MIN(sizeof(chunk), end - FILE_HEAD_SIZE - sent);
+
+        err = readFile(seq, FILE_HEAD_SIZE + sent, chunk, len);
+        if(!err)
+        {
+            err = sendFileChunk(name, chunk, len, end - FILE_HEAD_SIZE);
+        }
+        sent += len;
+    }
+
+    return err;
+}
+
+#else // CONFIG_LMTSDK_LOG_STORE_PARTITION
+
+static void filePath(char *p_path, uint32_t seq)
+{
+    snprintk(p_path, FILE_PATH_SIZE, FILE_PATH_FORMAT, (unsigned int)seq);
+}
+
+/**
+ * @brief Parses the sequence number of a log store file name
+ *
+ * @param p_name the file name
+ * @param p_seq pointer to the sequence number
+ * @return true if the name is a log store file name
+ */
+static bool parseName(const char *p_name, uint32_t *p_seq)
+{
+    size_t prefix_len = strlen(FILE_PREFIX);
+    char *p_end;
+
+    if(strncmp(p_name, FILE_PREFIX, prefix_len) != 0)
+    {
+        return false;
+    }
+
+    *p_seq = strtoul(&p_name[prefix_len], &p_end, 10);
+
+    return p_end != &p_name[prefix_len] && strcmp(p_end, FILE_SUFFIX) == 0;
+}
+
+/**
+ * @brief Persists the file sequence numbers, a lost catalogue is rebuilt from the directory
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+static int writeCatalogueLocked(void)
+{
+    char text[CATALOGUE_TEXT_SIZE];
+    int err;
+
+    snprintk(text, sizeof(text), "%u %u %u", (unsigned int)oldest_seq, (unsigned int)upload_seq,
+             (unsigned int)current_seq);
+    err = fileOverwrite(CATALOGUE_NAME, text);
+
+    return (err < 0) ? err : 0;
+}
+
+static int readCatalogueLocked(void)
+{
+    char text[CATALOGUE_TEXT_SIZE] = {0};
+    uint32_t seqs[3];
+    char *p_text = text;
+    int size     = getFileSize(CATALOGUE_NAME);
+
+    if(size <= 0 || fileRead(CATALOGUE_NAME, text, sizeof(text) - 1, 0, size) <= 0)
+    {
+        return -ENOENT;
+    }
+
+    for(size_t i = 0; i < ARRAY_SIZE(seqs); i++)
+    {
+        char *p_end;
+
+        seqs[i] = strtoul(p_text, &p_end, 10);
+        if(p_end == p_text)
+        {
+            return -EBADMSG;
+        }
+        p_text = p_end;
+    }
+
+    // oldest <= upload <= current in the sequence order
+    if((seqs[1] - seqs[0]) > (seqs[2] - seqs[0]))
+    {
+        return -EBADMSG;
+    }
+
+    oldest_seq  = seqs[0];
+    upload_seq  = seqs[1];
+    current_seq = seqs[2];
+
+    return 0;
+}
+
+/**
+ * @brief Rebuilds the catalogue from the directory, every file counts as not uploaded
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+static int scanLocked(void)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent entry;
+    bool found = false;
+    int err;
+
+    fs_dir_t_init(&dir);
+    err = fs_opendir(&dir, MOUNT_POINT);
+    if(err)
+    {
+        return err;
+    }
+
+    while(fs_readdir(&dir, &entry) == 0 && entry.name[0] != '\0')
+    {
+        uint32_t seq;
+
+        if(entry.type != FS_DIR_ENTRY_FILE || !parseName(entry.name, &seq))
+        {
+            continue;
+        }
+
+        oldest_seq  = found ? MIN(oldest_seq, seq) : seq;
+        current_seq = found ? MAX(current_seq, seq) : seq;
+        found       = true;
+    }
+    fs_closedir(&dir);
+
+    if(!found)
+    {
+        oldest_seq  = 0;
+        current_seq = 0;
+    }
+    upload_seq = oldest_seq;
+
+    return writeCatalogueLocked();
+}
+
+/**
+ * @brief Starts the next file and deletes the oldest files beyond getNumOfLogFiles().
+ * The page buffer has to be written before.
+ */
+static void rotateLocked(void)
+{
+    char name[FILE_PATH_SIZE];
+
+    current_seq++;
+    current_size = 0;
+
+    while((current_seq - oldest_seq) >= getNumOfLogFiles())
+    {
+        snprintk(name, sizeof(name), FILE_NAME_FORMAT, (unsigned int)oldest_seq);
+        deleteFile(name);
+        oldest_seq++;
+    }
+
+    if((upload_seq - oldest_seq) > (current_seq - oldest_seq))
+    {
+        // Deleted before it was uploaded
+        upload_seq = oldest_seq;
+    }
+    writeCatalogueLocked();
+}
+
+/**
+ * @brief Loads the catalogue of the previous boots, the new file follows the newest one
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+static int openLocked(void)
+{
+    char name[FILE_PATH_SIZE];
+    int err;
+
+    if(opened)
+    {
+        return 0;
+    }
+
+    if(readCatalogueLocked())
+    {
+        err = scanLocked();
+        if(err)
+        {
+            return err;
+        }
+    }
+
+    opened = true;
+
+    // Every boot starts a new file, an empty one is kept
+    snprintk(name, sizeof(name), FILE_NAME_FORMAT, (unsigned int)current_seq);
+    if(getFileSize(name) > 0)
+    {
+        rotateLocked();
+    }
+
+    return 0;
+}
+
+static int writeLocked(const void *p_data, size_t len)
+{
+    char path[FILE_PATH_SIZE];
+    struct fs_file_t file;
+    int err;
+
+    filePath(path, current_seq);
+    fs_file_t_init(&file);
+    err = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE | FS_O_APPEND);
+    if(err)
+    {
+        return err;
+    }
+
+    if(fs_write(&file, p_data, len) != (ssize_t)len)
+    {
+        err = -EIO;
+    }
+
+    // Closing syncs the file
+    if(fs_close(&file) && !err)
+    {
+        err = -EIO;
+    }
+
+    return err;
+}
+
+static void markUploadedLocked(uint32_t seq)
+{
+    if(upload_seq == seq)
+    {
+        upload_seq++;
+        writeCatalogueLocked();
+    }
+}
+
+/**
+ * @brief Sends one file with sendFileChunk()
+ *
+ * @param seq the sequence number of the file
+ * @return 0 on success, -ENOENT if the file is gone, negative error code on fail
+ */
+static int uploadFile(uint32_t seq)
+{
+    static char chunk[LOG_STORE_UPLOAD_CHUNK_SIZE];
+    char name[FILE_PATH_SIZE];
+    char path[FILE_PATH_SIZE];
+    struct fs_file_t file;
+    int total_size;
+    int err;
+
+    snprintk(name, sizeof(name), FILE_NAME_FORMAT, (unsigned int)seq);
+    total_size = getFileSize(name);
+    if(total_size <= 0)
+    {
+        return -ENOENT;
+    }
+
+    filePath(path, seq);
+    fs_file_t_init(&file);
+    err = fs_open(&file, path, FS_O_READ);
+    if(err)
+    {
+        return err;
+    }
+
+    for(int sent = 0; !err && sent < total_size;)
+    {
+        ssize_t len = fs_read(&file, chunk, MIN(sizeof(chunk), (size_t)(total_size - sent)));
+
+        if(len <= 0)
+        {
+            err = -EIO;
+            break;
+        }
+
+        err   = sendFileChunk(name, chunk, len, total_size);
+        sent += len;
+    }
+    fs_close(&file);
+
+    return err;
+}
+
+/**
+ * @brief Reads a part of a file
+ *
+ * @param seq the sequence number of the file
+ * @param offset the offset in the file
+ * @param p_data pointer to the buffer
+ * @param len the length to read
+ * @return 0 on success, -ENOENT if the file is gone, -ENODATA past the file end,
+ * negative errno code of the file system on fail
+ */
+static int readFile(uint32_t seq, size_t offset, void *p_data, size_t len)
+{
+    char path[FILE_PATH_SIZE];
+    struct fs_file_t file;
+    int err;
+
+    filePath(path, seq);
+    fs_file_t_init(&file);
+    err = fs_open(&file, path, FS_O_READ);
+    if(err)
+    {
+        return err;
+    }
+
+    err = fs_seek(&file, offset, FS_SEEK_SET);
+    if(!err && fs_read(&file, p_data, len) != (ssize_t)len)
+    {
+        err = -ENODATA;
+    }
+    fs_close(&file);
+
+    return err;
+}
+
+#endif // CONFIG_LMTSDK_LOG_STORE_PARTITION
+
+// Room left in the page buffer up to the next page boundary of the file
+static size_t pageRoomLocked(void)
+{
+    return LOG_STORE_PAGE_SIZE - (current_size % LOG_STORE_PAGE_SIZE) - page_len;
+}
+
+/**
+ * @brief Appends the page buffer to the current file. Every write ends at a page
+ * boundary of the file unless the page is flushed early, so LittleFS programs whole
+ * pages. A failed write loses the page, the file ends with a torn block then and the
+ * next blocks go to a new file.
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+static int writePageLocked(void)
+{
+    int err;
+
+    if(page_len == 0)
+    {
+        return 0;
+    }
+
+    LATENCY_START(write_start);
+    err = writeLocked(page, page_len);
+    LATENCY_STOP(LATENCY_LOG_STORE_WRITE, write_start);
+    if(err)
+    {
+        page_len = 0;
+        rotateLocked();
+        return err;
+    }
+    current_size += page_len;
+    page_len      = 0;
+
+    return 0;
+}
+
+static int putLocked(const void *p_data, size_t len)
+{
+    const uint8_t *p_byte = p_data;
+    int err               = 0;
+
+    while(!err && len > 0)
+    {
+        size_t part = MIN(len, pageRoomLocked());
+
+        memcpy(&page[page_len], p_byte, part);
+        page_len += part;
+        p_byte   += part;
+        len      -= part;
+
+        if(pageRoomLocked() == 0)
+        {
+            err = writePageLocked();
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @brief Compresses the block into the page buffer, starting the next file first if the
+ * block would take the current one over getLogFileMaxSize()
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+static int sealBlockLocked(void)
+{
+    LogStoreBlockHead head = {.magic = IS_ENABLED(CONFIG_LMTSDK_LOG_STORE_DICTIONARY)
+                                           ? LOG_STORE_DICTIONARY_BLOCK_MAGIC
+                                           : LOG_STORE_BLOCK_MAGIC};
+    const uint8_t *p_payload;
+    size_t size;
+    int len;
+    int err;
+
+    if(block_len == 0)
+    {
+        return 0;
+    }
+
+    err = openLocked();
+    if(err)
+    {
+        return err;
+    }
+
+    // Only a block that gets smaller is stored compressed
+    len = uplinkCompressWithDictionary(NULL, 0, (const uint8_t *)block, block_len,
+                                       compressed, block_len - 1);
+    if(len > 0)
+    {
+        p_payload = compressed;
+    }
+    else
+    {
+        p_payload = (const uint8_t *)block;
+        len       = block_len;
+    }
+
+    head.raw_len = block_len;
+    head.len     = len;
+    head.records = block_records;
+    head.levels  = block_levels;
+    head.first   = block_first;
+    head.last    = block_last;
+    head.crc     = crc32_ieee(p_payload, len);
+
+    size = current_size + page_len;
+    if(size > FILE_HEAD_SIZE && (size + sizeof(head) + len) > FILE_MAX_SIZE)
+    {
+        // A failed write has started the next file already
+        if(writePageLocked() == 0)
+        {
+            rotateLocked();
+        }
+    }
+
+    err = putLocked(&head, sizeof(head));
+    if(!err)
+    {
+        err = putLocked(p_payload, len);
+    }
+    block_len     = 0;
+    block_records = 0;
+    block_levels  = 0;
+
+    return err;
+}
+
+/**
+ * @brief Writes the block and the page buffer to flash
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+static int flushLocked(void)
+{
+    int err = sealBlockLocked();
+
+    return err ? err : writePageLocked();
+}
+
+/**
+ * @brief Formats a log line ("<unix ms> <E|W|I> <text>"), a line that does not fit is cut
+ *
+ * @param p_out pointer to the output buffer
+ * @param room size of the output buffer
+ * @param level the level of the line
+ * @param timestamp the time of the line
+ * @param format printf style format string
+ * @param args the format arguments
+ * @return length of the line
+ */
+static int formatLine(char *p_out, size_t room, LogLevel level, int64_t timestamp,
+                      const char *format, va_list args)
+{
+    int len = snprintk(p_out, room, "%lld %c ", (long long)timestamp, level_letters[level]);
+
+    if(len >= 0 && (size_t)len < room)
+    {
+        len += vsnprintk(&p_out[len], room - len, format, args);
+    }
+
+    if(len >= 0 && (size_t)len < room)
+    {
+        p_out[len] = '\n';
+        return len + 1;
+    }
+
+    p_out[room - 1] = '\n';
+
+    return room;
+}
+
+static int putArg(uint8_t *p_out, size_t room, size_t *p_used, const void *p_value, size_t size)
+{
+    if((room - *p_used) < size)
+    {
+        return -ENOMEM;
+    }
+    memcpy(&p_out[*p_used], p_value, size);
+    *p_used += size;
+
+    return 0;
+}
+
+/**
+ * @brief Packs the arguments of the format conversions, see LogStoreRecordHead
+ *
+ * @param p_out pointer to the output buffer
+ * @param room size of the output buffer
+ * @param format printf style format string
+ * @param args the format arguments
+ * @return length of the packed arguments, -ENOMEM if they do not fit
+ */
+static int packArgs(uint8_t *p_out, size_t room, const char *format, va_list args)
+{
+    size_t used = 0;
+    int err     = 0;
+
+    for(const char *p = format; !err && *p != '\0'; p++)
+    {
+        size_t longs = 0;
+        bool sized   = false;
+        uint32_t value;
+
+        if(*p != '%' || *(++p) == '%')
+        {
+            continue;
+        }
+
+        // Flags, width and precision, a '*' takes an int argument
+        for(; *p != '\0' && strchr("-+ #0123456789.*", *p); p++)
+        {
+            if(*p == '*')
+            {
+                value = va_arg(args, int);
+                err   = putArg(p_out, room, &used, &value, sizeof(value));
+            }
+        }
+
+        for(; *p != '\0' && strchr("hljzt", *p); p++)
+        {
+            if(*p == 'l' || *p == 'j')
+            {
+                longs += (*p == 'l') ? 1 : 2;
+            }
+            sized = sized || *p == 'z' || *p == 't';
+        }
+
+        if(err || *p == '\0')
+        {
+            break;
+        }
+
+        if(strchr("diouxXc", *p))
+        {
+            if(longs >= 2)
+            {
+                long long wide = va_arg(args, long long);
+
+                err = putArg(p_out, room, &used, &wide, sizeof(wide));
+                continue;
+            }
+
+            if(sized)
+            {
+                value = va_arg(args, size_t);
+            }
+            else if(longs == 1)
+            {
+                value = va_arg(args, long);
+            }
+            else
+            {
+                value = va_arg(args, int);
+            }
+            err = putArg(p_out, room, &used, &value, sizeof(value));
+        }
+        else if(strchr("eEfFgGaA", *p))
+        {
+            double real = va_arg(args, double);
+
+            err = putArg(p_out, room, &used, &real, sizeof(real));
+        }
+        else if(*p == 'p')
+        {
+            value = (uintptr_t)va_arg(args, void *);
+            err   = putArg(p_out, room, &used, &value, sizeof(value));
+        }
+        else if(*p == 's')
+        {
+            const char *p_string = va_arg(args, const char *);
+            size_t len           = strlen(p_string ? p_string : "(null)") + 1;
+
+            // Strings are cut to fit
+            if(len > (room - used) && used < room)
+            {
+                len = room - used;
+            }
+            err = putArg(p_out, room, &used, p_string ? p_string : "(null)", len);
+            if(!err)
+            {
+                p_out[used - 1] = '\0';
+            }
+        }
+        else if(*p == 'n')
+        {
+            (void)va_arg(args, void *);
+        }
+        else
+        {
+            // Unknown conversion, the decoder stops at it as well
+            break;
+        }
+    }
+
+    return err ? err : (int)used;
+}
+
+/*
+ * Base of the format offsets of the dictionary records. An offset from a symbol of the
+ * same image fits 32 bits also on the 64-bit native_sim host, and the decoder finds the
+ * symbol in the ELF symbol table.
+ */
+const char log_store_format_base[] = "";
+
+/**
+ * @brief Packs a dictionary record, see LogStoreRecordHead
+ *
+ * @param p_out pointer to the output buffer
+ * @param room size of the output buffer
+ * @param level the level of the record
+ * @param timestamp the time of the record
+ * @param format printf style format string literal
+ * @param args the format arguments
+ * @return length of the record, -ENOMEM if it does not fit
+ */
+static int packRecord(uint8_t *p_out, size_t room, LogLevel level, int64_t timestamp,
+                      const char *format, va_list args)
+{
+    LogStoreRecordHead head = {
+        .level     = level,
+        .timestamp = timestamp,
+        .format    = (int32_t)((intptr_t)format - (intptr_t)log_store_format_base)};
+    int len;
+
+    if(room < sizeof(head))
+    {
+        return -ENOMEM;
+    }
+
+    len = packArgs(&p_out[sizeof(head)], room - sizeof(head), format, args);
+    if(len < 0)
+    {
+        return len;
+    }
+
+    head.len = len;
+    memcpy(p_out, &head, sizeof(head));
+
+    return sizeof(head) + len;
+}
+
+/**
+ * @brief Appends a record taken from the queue to the block, flushing the block first
+ * if the record does not fit
+ *
+ * @param p_slot the queue slot of the record
+ * @return 0 on success, negative errno code on fail
+ */
+static int appendLocked(const LogStoreSlot *p_slot)
+{
+    int err = 0;
+
+    if((block_len + p_slot->len) > sizeof(block))
+    {
+        err = sealBlockLocked();
+        if(err)
+        {
+            return err;
+        }
+    }
+
+    if(block_records == 0)
+    {
+        block_first = p_slot->timestamp;
+    }
+    block_last    = p_slot->timestamp;
+    block_levels |= BIT(p_slot->level);
+
+    memcpy(&block[block_len], p_slot->data, p_slot->len);
+    block_len += p_slot->len;
+    block_records++;
+
+    return (block_len == sizeof(block)) ? sealBlockLocked() : 0;
+}
+
+/**
+ * @brief Moves the published records from the queue to the block, the single consumer
+ * of the queue is whoever holds store_mutex.
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+static int drainLocked(void)
+{
+    int err = 0;
+
+    while(!err)
+    {
+        LogStoreSlot *p_slot = &slots[tail & (LOG_STORE_QUEUE_LENGTH - 1)];
+
+        if((int32_t)((uint32_t)atomic_get(&p_slot->seq) - (tail + 1)) != 0)
+        {
+            break;
+        }
+
+        if(p_slot->len > 0)
+        {
+            err = appendLocked(p_slot);
+        }
+
+        if(!err)
+        {
+            // Free for the producers of the next lap
+            atomic_set(&p_slot->seq, (atomic_val_t)(tail + LOG_STORE_QUEUE_LENGTH));
+            tail++;
+        }
+    }
+
+    return err;
+}
+
+static void flushWorkFn(struct k_work *p_work)
+{
+    ARG_UNUSED(p_work);
+
+    // The store thread writes, the system work queue does not wait for flash
+    atomic_set(&flush_due, 1);
+    k_sem_give(&queue_sem);
+}
+
+static K_WORK_DELAYABLE_DEFINE(flush_work, flushWorkFn);
+
+static void logStoreThread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg1);
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    while(true)
+    {
+        k_sem_take(&queue_sem, K_FOREVER);
+        k_mutex_lock(&store_mutex, K_FOREVER);
+        drainLocked();
+        if(atomic_clear(&flush_due))
+        {
+            flushLocked();
+        }
+        else if(LOG_STORE_FLUSH_INTERVAL_MS > 0 && (block_len > 0 || page_len > 0))
+        {
+            // Pending lines reach flash at most one interval after they are taken
+            k_work_schedule(&flush_work, K_MSEC(LOG_STORE_FLUSH_INTERVAL_MS));
+        }
+        k_mutex_unlock(&store_mutex);
+    }
+}
+
+K_THREAD_DEFINE(log_store_thread, LOG_STORE_THREAD_STACK_SIZE, logStoreThread, NULL, NULL, NULL,
+                LOG_STORE_THREAD_PRIORITY, 0, 0);
+
+static int logStoreInit(void)
+{
+    for(size_t i = 0; i < LOG_STORE_QUEUE_LENGTH; i++)
+    {
+        atomic_set(&slots[i].seq, i);
+    }
+
+    return 0;
+}
+
+SYS_INIT(logStoreInit, APPLICATION, 0);
+
+/**
+ * @brief Claims the queue slot of the next position, lock-free for any number of producers
+ *
+ * @param p_position pointer to the claimed position
+ * @return pointer to the slot, NULL if the queue is full
+ */
+static LogStoreSlot *claimSlot(uint32_t *p_position)
+{
+    uint32_t position = (uint32_t)atomic_get(&head);
+
+    while(true)
+    {
+        LogStoreSlot *p_slot = &slots[position & (LOG_STORE_QUEUE_LENGTH - 1)];
+        int32_t lap          = (int32_t)((uint32_t)atomic_get(&p_slot->seq) - position);
+
+        if(lap == 0)
+        {
+            if(atomic_cas(&head, (atomic_val_t)position, (atomic_val_t)(position + 1)))
+            {
+                *p_position = position;
+                return p_slot;
+            }
+        }
+        else if(lap < 0)
+        {
+            // Not drained since the previous lap
+            return NULL;
+        }
+        position = (uint32_t)atomic_get(&head);
+    }
+}
+
+int logStoreWrite(LogLevel level, const char *text)
+{
+    return (text == NULL) ? -EINVAL : logStoreWriteFormatted(level, "%s", text);
+}
+
+int logStoreWriteFormatted(LogLevel level, const char *format, ...)
+{
+    LogStoreSlot *p_slot;
+    uint32_t position;
+    int64_t timestamp;
+    va_list args;
+    int len;
+
+    if(format == NULL || level > LOG_INFORMATIVE)
+    {
+        return -EINVAL;
+    }
+
+    if(level > getLogLevel())
+    {
+        return 0;
+    }
+
+    if(date_time_now(&timestamp))
+    {
+        timestamp = k_uptime_get();
+    }
+
+    p_slot = claimSlot(&position);
+    if(p_slot == NULL)
+    {
+        atomic_inc(&dropped);
+        k_sem_give(&queue_sem);
+        return -ENOBUFS;
+    }
+
+    va_start(args, format);
+    if(IS_ENABLED(CONFIG_LMTSDK_LOG_STORE_DICTIONARY))
+    {
+        len = packRecord(p_slot->data, sizeof(p_slot->data), level, timestamp, format, args);
+    }
+    else
+    {
+        len = formatLine((char *)p_slot->data, sizeof(p_slot->data), level, timestamp, format,
+                         args);
+    }
+    va_end(args);
+
+    // A record that cannot be packed is still published, empty, to keep the queue order
+    p_slot->timestamp = timestamp;
+    p_slot->level     = level;
+    p_slot->len       = MAX(len, 0);
+    atomic_set(&p_slot->seq, (atomic_val_t)(position + 1));
+    if(IS_ENABLED(CONFIG_LMTSDK_LOG_STORE_FLUSH_ON_ERROR) && level == LOG_ERRORS)
+    {
+        atomic_set(&flush_due, 1);
+    }
+    k_sem_give(&queue_sem);
+
+    return (len < 0) ? -EMSGSIZE : 0;
+}
+
+int logStoreFlush(void)
+{
+    int err;
+
+    k_mutex_lock(&store_mutex, K_FOREVER);
+    err = drainLocked();
+    if(!err)
+    {
+        err = flushLocked();
+    }
+    k_mutex_unlock(&store_mutex);
+
+    return err;
+}
+
+uint32_t logStoreGetDropped(void)
+{
+    return (uint32_t)atomic_get(&dropped);
+}
+
+int logStoreUpload(void)
+{
+    uint32_t first;
+    uint32_t last;
+    int err;
+
+    k_mutex_lock(&store_mutex, K_FOREVER);
+    err = openLocked();
+    if(!err)
+    {
+        err = drainLocked();
+    }
+    if(!err)
+    {
+        err = flushLocked();
+    }
+
+    if(!err && current_size > FILE_HEAD_SIZE)
+    {
+        // The current file is sent as it is now, new blocks go to the next one
+        rotateLocked();
+    }
+    first = upload_seq;
+    last  = current_seq;
+    k_mutex_unlock(&store_mutex);
+
+    for(uint32_t seq = first; !err && seq != last; seq++)
+    {
+        err = uploadFile(seq);
+        if(err == -ENOENT)
+        {
+            // Deleted by the rotation meanwhile
+            err = 0;
+        }
+
+        if(!err)
+        {
+            k_mutex_lock(&store_mutex, K_FOREVER);
+            markUploadedLocked(seq);
+            k_mutex_unlock(&store_mutex);
+        }
+    }
+
+    return err;
+}
+
+/*
+ * Ranged upload. The matching records of every stored block are compressed into one block
+ * of the store format, so the upload decodes like a log store file. A selection pass walks
+ * the files newest first and marks the oldest block that still fits the byte budget, so a
+ * budget keeps the newest lines. The blocks from the mark on are then written in order to
+ * a scratch file, which is uploaded with its final size: sendFileChunk() announces the
+ * total size with every chunk, and files rotated away meanwhile only shorten the upload.
+ */
+typedef struct
+{
+    uint32_t seq;  // File of the oldest block sent
+    size_t offset; // Offset of its block head
+    size_t start;  // Offset of its oldest record sent, in the matching records
+} RangeMark;
+
+typedef struct
+{
+    const LogStoreFilter *p_filter;
+    uint16_t magic;           // Magic of the block filtered to out
+    size_t out_len;           // Matching records of the block
+    LogStoreBlockHead head;   // Head of the block sealed from out
+    const uint8_t *p_payload; // Payload of the sealed block
+    size_t size;              // Written to the scratch file
+    struct fs_file_t file;
+    uint8_t payload[LOG_STORE_BLOCK_SIZE]; // Block read from flash, then the block sealed
+    uint8_t raw[LOG_STORE_BLOCK_SIZE + 1]; // Zero terminated for the text parsing
+    uint8_t out[LOG_STORE_BLOCK_SIZE + 1];
+    char chunk[LOG_STORE_UPLOAD_CHUNK_SIZE];
+} RangeContext;
+
+static RangeContext range;
+static K_MUTEX_DEFINE(range_mutex);
+
+/**
+ * @brief Parses the record at an offset of a zero terminated block text
+ *
+ * @param p_record pointer to the record
+ * @param room the bytes left in the block
+ * @param p_level pointer to the level of the record
+ * @param p_timestamp pointer to the timestamp of the record
+ * @return length of the record, 0 if a dictionary record head is cut
+ */
+static size_t rangeRecord(const uint8_t *p_record, size_t room, LogLevel *p_level,
+                          int64_t *p_timestamp)
+{
+    const uint8_t *p_end;
+    const char *p_letter;
+    char *p_space;
+
+    if(range.magic == LOG_STORE_DICTIONARY_BLOCK_MAGIC)
+    {
+        LogStoreRecordHead head;
+
+        if(room < sizeof(head))
+        {
+            return 0;
+        }
+        memcpy(&head, p_record, sizeof(head));
+        *p_level     = head.level;
+        *p_timestamp = head.timestamp;
+
+        return MIN(sizeof(head) + head.len, room);
+    }
+
+    // "<unix ms> <E|W|I> <text>\n"
+    p_end        = memchr(p_record, '\n', room);
+    *p_timestamp = strtoll((const char *)p_record, &p_space, 10);
+    p_letter = (*p_space == ' ') ? memchr(level_letters, p_space[1], sizeof(level_letters)) : NULL;
+    *p_level = (p_letter != NULL) ? (LogLevel)(p_letter - level_letters) : LOG_INFORMATIVE;
+
+    return (p_end != NULL) ? (size_t)(p_end - p_record + 1) : room;
+}
+
+/**
+ * @brief Compresses the matching records from an offset on into one block
+ *
+ * @param start the offset of the oldest record in range.out
+ * @return size of the block, head included, 0 if no record is left
+ */
+static size_t rangeSeal(size_t start)
+{
+    LogStoreBlockHead *p_head = &range.head;
+    size_t raw_len            = range.out_len - start;
+    int len;
+
+    *p_head = (LogStoreBlockHead){.magic = range.magic, .raw_len = raw_len};
+    if(raw_len == 0)
+    {
+        return 0;
+    }
+
+    for(size_t offset = start; offset < range.out_len;)
+    {
+        LogLevel level;
+        int64_t timestamp;
+        size_t record_len =
+            rangeRecord(&range.out[offset], range.out_len - offset, &level, &timestamp);
+
+        if(record_len == 0)
+        {
+            break;
+        }
+
+        if(p_head->records == 0)
+        {
+            p_head->first = timestamp;
+        }
+        p_head->last    = timestamp;
+        p_head->levels |= BIT(level);
+        p_head->records++;
+        offset += record_len;
+    }
+
+    len = uplinkCompressWithDictionary(NULL, 0, &range.out[start], raw_len, range.payload,
+                                       raw_len - 1);
+    if(len > 0)
+    {
+        range.p_payload = range.payload;
+    }
+    else
+    {
+        range.p_payload = &range.out[start];
+        len             = raw_len;
+    }
+    p_head->len = len;
+    p_head->crc = crc32_ieee(range.p_payload, len);
+
+    return sizeof(*p_head) + len;
+}
+
+/**
+ * @brief Reads a block of a file and copies its matching records to range.out. The block
+ * heads are the time index: a block out of the range or without a matching level is
+ * skipped without reading its payload.
+ *
+ * @param seq the sequence number of the file
+ * @param p_offset pointer to the offset of the block head, moved to the next head
+ * @param end the offset the file is read up to
+ * @return 0 on success (range.out_len is 0 for a skipped or damaged block), -ENODATA past
+ * the last block, -ENOENT if the file is gone, negative errno code on fail
+ */
+static int rangeBlock(uint32_t seq, size_t *p_offset, size_t end)
+{
+    const LogStoreFilter *p_filter = range.p_filter;
+    uint8_t levels                 = BIT(p_filter->level + 1) - 1;
+    LogStoreBlockHead head;
+    uint8_t *p_read;
+    size_t offset = *p_offset;
+    int err;
+
+    range.out_len = 0;
+    if((offset + sizeof(head)) > end)
+    {
+        return -ENODATA;
+    }
+
+    err = readFile(seq, offset, &head, sizeof(head));
+    if(err)
+    {
+        return err;
+    }
+
+    if((head.magic != LOG_STORE_BLOCK_MAGIC && head.magic != LOG_STORE_DICTIONARY_BLOCK_MAGIC) ||
+       head.len > LOG_STORE_BLOCK_SIZE || head.raw_len > LOG_STORE_BLOCK_SIZE)
+    {
+        return -ENODATA;
+    }
+    offset    += sizeof(head);
+    *p_offset  = offset + head.len;
+
+    if(head.last < p_filter->from || head.first > p_filter->to || !(head.levels & levels))
+    {
+        return 0;
+    }
+
+    // A block stored as it is goes straight to raw
+    p_read = (head.len == head.raw_len) ? range.raw : range.payload;
+    err    = readFile(seq, offset, p_read, head.len);
+    if(err)
+    {
+        return err;
+    }
+
+    if(crc32_ieee(p_read, head.len) != head.crc ||
+       (head.len != head.raw_len &&
+        uplinkDecompressWithDictionary(NULL, 0, range.payload, head.len, range.raw,
+                                       head.raw_len) != head.raw_len))
+    {
+        // Damaged block, the next head is still in place
+        return 0;
+    }
+
+    range.magic            = head.magic;
+    range.raw[head.raw_len] = '\0';
+    for(size_t raw_offset = 0; raw_offset < head.raw_len;)
+    {
+        LogLevel level;
+        int64_t timestamp;
+        size_t len =
+            rangeRecord(&range.raw[raw_offset], head.raw_len - raw_offset, &level, &timestamp);
+
+        if(len == 0)
+        {
+            break;
+        }
+
+        if(level <= p_filter->level && timestamp >= p_filter->from && timestamp <= p_filter->to)
+        {
+            memcpy(&range.out[range.out_len], &range.raw[raw_offset], len);
+            range.out_len += len;
+        }
+        raw_offset += len;
+    }
+    range.out[range.out_len] = '\0';
+
+    return 0;
+}
+
+/**
+ * @brief Marks the oldest block of a file, cut to its newest records if needed, from which
+ * the rest of the file fits the room
+ *
+ * @param seq the sequence number of the file
+ * @param end the offset the file is read up to
+ * @param room the byte budget left
+ * @param file_size the size of the whole file in the upload
+ * @param p_mark pointer to the mark
+ * @return size of the marked part in the upload, negative errno code on fail
+ */
+static int rangeCut(uint32_t seq, size_t end, size_t room, size_t file_size, RangeMark *p_mark)
+{
+    size_t offset = FILE_HEAD_SIZE;
+    size_t rest   = file_size;
+
+    while(true)
+    {
+        size_t block_offset = offset;
+        int err             = rangeBlock(seq, &offset, end);
+
+        if(err)
+        {
+            // Rotated away since the size was taken
+            return (err == -ENODATA || err == -ENOENT) ? 0 : err;
+        }
+
+        // Size of the blocks after this one
+        rest -= MIN(rangeSeal(0), rest);
+        if(rest > room)
+        {
+            continue;
+        }
+
+        // The newest records of this block that fit next to the rest
+        for(size_t start = 0; start < range.out_len;)
+        {
+            LogLevel level;
+            int64_t timestamp;
+            size_t len = rangeRecord(&range.out[start], range.out_len - start, &level, &timestamp);
+            size_t size;
+
+            if(len == 0)
+            {
+                break;
+            }
+            start += len;
+
+            size = rangeSeal(start);
+            if(size > 0 && (rest + size) <= room)
+            {
+                *p_mark = (RangeMark){.seq = seq, .offset = block_offset, .start = start};
+                return rest + size;
+            }
+        }
+
+        *p_mark = (RangeMark){.seq = seq, .offset = offset, .start = 0};
+        return rest;
+    }
+}
+
+/**
+ * @brief Walks the files newest first and marks the oldest block that still fits the byte
+ * budget. Only the oldest block of the upload is cut, to its newest records.
+ *
+ * @param first the oldest file
+ * @param last the newest file
+ * @param last_size the size of the newest file
+ * @param p_mark pointer to the mark
+ * @return 0 on success, -ENODATA if no record matches, negative errno code on fail
+ */
+static int rangeSelect(uint32_t first, uint32_t last, size_t last_size, RangeMark *p_mark)
+{
+    size_t room  = range.p_filter->max_bytes;
+    size_t total = 0;
+    int err      = 0;
+
+    for(uint32_t seq = last; !err; seq--)
+    {
+        size_t end       = (seq == last) ? last_size : SIZE_MAX;
+        size_t offset    = FILE_HEAD_SIZE;
+        size_t file_size = 0;
+
+        while((err = rangeBlock(seq, &offset, end)) == 0)
+        {
+            file_size += rangeSeal(0);
+        }
+
+        // An empty current file does not exist yet
+        if(err != -ENODATA && err != -ENOENT)
+        {
+            break;
+        }
+        err = 0;
+
+        if(file_size > (room - total))
+        {
+            err = rangeCut(seq, end, room - total, file_size, p_mark);
+            if(err > 0)
+            {
+                total += err;
+                err    = 0;
+            }
+            break;
+        }
+
+        total   += file_size;
+        *p_mark  = (RangeMark){.seq = seq, .offset = FILE_HEAD_SIZE, .start = 0};
+        if(seq == first)
+        {
+            break;
+        }
+    }
+
+    return err ? err : ((total > 0) ? 0 : -ENODATA);
+}
+
+static int rangeWrite(const void *p_data, size_t len)
+{
+    if(fs_write(&range.file, p_data, len) != (ssize_t)len)
+    {
+        return -EIO;
+    }
+    range.size += len;
+
+    return 0;
+}
+
+/**
+ * @brief Writes the blocks from the mark on to the scratch file, oldest first
+ *
+ * @param p_mark the mark of the oldest block
+ * @param last the newest file
+ * @param last_size the size of the newest file
+ * @return 0 on success, negative errno code on fail
+ */
+static int rangeEmit(const RangeMark *p_mark, uint32_t last, size_t last_size)
+{
+    int err;
+
+    range.size = 0;
+    fs_file_t_init(&range.file);
+    err = fs_open(&range.file, RANGE_PATH, FS_O_CREATE | FS_O_WRITE);
+    if(err)
+    {
+        return err;
+    }
+
+    for(uint32_t seq = p_mark->seq; !err; seq++)
+    {
+        size_t end    = (seq == last) ? last_size : SIZE_MAX;
+        size_t offset = (seq == p_mark->seq) ? p_mark->offset : FILE_HEAD_SIZE;
+
+        while(!err)
+        {
+            bool marked = (seq == p_mark->seq && offset == p_mark->offset);
+
+            err = rangeBlock(seq, &offset, end);
+            if(!err && rangeSeal(marked ? p_mark->start : 0) > 0)
+            {
+                err = rangeWrite(&range.head, sizeof(range.head));
+                err = err ? err : rangeWrite(range.p_payload, range.head.len);
+            }
+        }
+
+        // A file rotated away only shortens the upload
+        if(err == -ENODATA || err == -ENOENT)
+        {
+            err = 0;
+        }
+
+        if(seq == last)
+        {
+            break;
+        }
+    }
+
+    if(fs_close(&range.file) && !err)
+    {
+        err = -EIO;
+    }
+
+    return err;
+}
+
+/**
+ * @brief Sends the scratch file with sendFileChunk()
+ *
+ * @return 0 on success, -ENODATA if it is empty, negative error code on fail
+ */
+static int rangeUpload(void)
+{
+    int err;
+
+    if(range.size == 0)
+    {
+        return -ENODATA;
+    }
+
+    fs_file_t_init(&range.file);
+    err = fs_open(&range.file, RANGE_PATH, FS_O_READ);
+    if(err)
+    {
+        return err;
+    }
+
+    for(size_t sent = 0; !err && sent < range.size;)
+    {
+        ssize_t len =
+            fs_read(&range.file, range.chunk, MIN(sizeof(range.chunk), range.size - sent));
+
+        if(len <= 0)
+        {
+            err = -EIO;
+            break;
+        }
+
+        err   = sendFileChunk(RANGE_NAME, range.chunk, len, range.size);
+        sent += len;
+    }
+    fs_close(&range.file);
+
+    return err;
+}
+
+int logStoreParseFilter(const char *p_text, LogStoreFilter *p_filter)
+{
+    if(p_text == NULL || p_filter == NULL)
+    {
+        return -EINVAL;
+    }
+
+    *p_filter = (LogStoreFilter){
+        .from = INT64_MIN, .to = INT64_MAX, .level = LOG_INFORMATIVE, .max_bytes = SIZE_MAX};
+
+    while(*p_text != '\0')
+    {
+        const char *p_value;
+        const char *p_letter;
+        char *p_end;
+        size_t key_len;
+        long long value;
+
+        if(*p_text == ' ')
+        {
+            p_text++;
+            continue;
+        }
+
+        p_value = strchr(p_text, '=');
+        if(p_value == NULL)
+        {
+            return -EINVAL;
+        }
+        key_len = p_value - p_text;
+        p_value++;
+
+        p_letter = (*p_value != '\0') ? memchr(level_letters, *p_value, sizeof(level_letters))
+                                      : NULL;
+        if(p_letter != NULL)
+        {
+            value = p_letter - level_letters;
+            p_end = (char *)p_value + 1;
+        }
+        else
+        {
+            value = strtoll(p_value, &p_end, 10);
+        }
+
+        if(p_end == p_value || (*p_end != ' ' && *p_end != '\0'))
+        {
+            return -EINVAL;
+        }
+
+        if(key_len == 4 && strncmp(p_text, "from", key_len) == 0)
+        {
+            p_filter->from = value;
+        }
+        else if(key_len == 2 && strncmp(p_text, "to", key_len) == 0)
+        {
+            p_filter->to = value;
+        }
+        else if(key_len == 5 && strncmp(p_text, "level", key_len) == 0 &&
+                value >= LOG_ERRORS && value <= LOG_INFORMATIVE)
+        {
+            p_filter->level = value;
+        }
+        else if(key_len == 3 && strncmp(p_text, "max", key_len) == 0 && value > 0)
+        {
+            p_filter->max_bytes = value;
+        }
+        else
+        {
+            return -EINVAL;
+        }
+        p_text = p_end;
+    }
+
+    return 0;
+}
+
+int logStoreUploadRange(const LogStoreFilter *p_filter)
+{
+    RangeMark mark;
+    uint32_t first;
+    uint32_t last;
+    size_t last_size;
+    int err;
+
+    if(p_filter == NULL)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&store_mutex, K_FOREVER);
+    err = openLocked();
+    if(!err)
+    {
+        err = drainLocked();
+    }
+    if(!err)
+    {
+        err = flushLocked();
+    }
+    first     = oldest_seq;
+    last      = current_seq;
+    last_size = current_size;
+    k_mutex_unlock(&store_mutex);
+
+    if(err)
+    {
+        return err;
+    }
+
+    k_mutex_lock(&range_mutex, K_FOREVER);
+    range.p_filter = p_filter;
+    err            = rangeSelect(first, last, last_size, &mark);
+    if(!err)
+    {
+        deleteFile(RANGE_FILE_NAME);
+        err = rangeEmit(&mark, last, last_size);
+    }
+    if(!err)
+    {
+        err = rangeUpload();
+    }
+    deleteFile(RANGE_FILE_NAME);
+    k_mutex_unlock(&range_mutex);
+
+    return err;
+}
@@ -0,0 +1,721 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_tape_packer.h"
+#include "lmt_coap_manager.h"
+#include "lmt_latency.h"
+#include "lmt_settings.h"
+#include <date_time.h>
+#include <errno.h>
+#include <pb_decode.h>
+#include <pb_encode.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+BUILD_ASSERT(TAPE_COUNT <= ARRAY_SIZE(((TapeUplink *)0)->Tape), "Update A2Tape.options");
+BUILD_ASSERT(MAX_TRACKS_COUNT == ARRAY_SIZE(((TapeColumn *)0)->Track), "Update A2Tape.options");
+BUILD_ASSERT(MAX_PERIODS_COUNT == ARRAY_SIZE(((TapeData *)0)->Periods), "Update A2Tape.options");
+
+#define RAW_DATA_MODE 1
+
+#define ALL_TRACKS_MASK (BIT(MAX_TRACKS_COUNT) - 1)
+
+// Worst case size of the TapeUplink Timestamp field
+#define TIMESTAMP_FIELD_MAX_SIZE 11
+
+typedef struct
+{
+    TapeEncoding encoding;
+    uint32_t track_mask;            // Tracks sent in the columns, 0 for all
+    pb_size_t periods_count;
+    TapePeriod periods[MAX_PERIODS_COUNT];
+    pb_size_t columns_count;
+    pb_size_t columns_limit;        // Column count that triggers the Tape full
+    int32_t last[MAX_TRACKS_COUNT]; // Last added column, base of the next delta
+    size_t columns_size;            // Encoded size of the Columns field
+    size_t last_column_size;        // Encoded size of the last added column
+} Tape;
+
+typedef struct
+{
+    uint8_t i_tape;
+    int32_t *p_columns;
+    size_t max_columns;
+    size_t columns_count;
+} TapeDecodeContext;
+
+static Tape tapes[TAPE_COUNT];
+
+// Columns of all Tapes share one pool in the order they were added
+static int32_t column_pool[TAPE_MAX_COLUMNS_COUNT][MAX_TRACKS_COUNT];
+static uint8_t column_tape[TAPE_MAX_COLUMNS_COUNT];
+static pb_size_t pool_count;
+
+static K_MUTEX_DEFINE(tape_mutex);
+
+static size_t varintSize(uint64_t value)
+{
+    size_t size = 1;
+
+    while(value > 0x7F)
+    {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+static size_t submessageSize(size_t size)
+{
+    // One byte tag + length prefix + content
+    return 1 + varintSize(size) + size;
+}
+
+static uint64_t getTimestamp(void)
+{
+    int64_t timestamp = 0;
+
+    if(date_time_now(&timestamp))
+    {
+        return 0;
+    }
+
+    return (uint64_t)timestamp;
+}
+
+static uint32_t trackMask(uint32_t mask)
+{
+    return mask ? mask : ALL_TRACKS_MASK;
+}
+
+/**
+ * @brief Fills the TapeColumn with the Tracks of the Tape mask in the Tape encoding.
+ * Deltas use unsigned wrap-around, so any int32_t pair round-trips.
+ *
+ * @param p_tape the Tape
+ * @param p_values the column values
+ * @param p_previous the previous column values of the same Tape, NULL for the first column
+ * @param p_column the TapeColumn to fill
+ */
+static void fillColumn(const Tape *p_tape, const int32_t *p_values, const int32_t *p_previous,
+                       TapeColumn *p_column)
+{
+    uint32_t mask = trackMask(p_tape->track_mask);
+
+    memset(p_column, 0, sizeof(*p_column));
+
+    for(int i = 0; i < MAX_TRACKS_COUNT; i++)
+    {
+        if(!(mask & BIT(i)))
+        {
+            continue;
+        }
+
+        if(p_tape->encoding == TAPE_DELTA_ZIGZAG)
+        {
+            uint32_t previous = p_previous ? (uint32_t)p_previous[i] : 0;
+
+            p_column->TrackDelta[p_column->TrackDelta_count++] =
+                (int32_t)((uint32_t)p_values[i] - previous);
+        }
+        else
+        {
+            p_column->Track[p_column->Track_count++] = p_values[i];
+        }
+    }
+}
+
+static size_t columnSize(const Tape *p_tape, const int32_t *p_values)
+{
+    TapeColumn column;
+    size_t size = 0;
+
+    fillColumn(p_tape, p_values, p_tape->columns_count ? p_tape->last : NULL, &column);
+    pb_get_encoded_size(&size, TapeColumn_fields, &column);
+
+    return submessageSize(size);
+}
+
+static size_t tapeSizeLocked(uint8_t i_tape)
+{
+    const Tape *p_tape = &tapes[i_tape];
+    size_t size        = p_tape->columns_size;
+
+    if(i_tape > 0)
+    {
+        size += 1 + varintSize(i_tape);
+    }
+
+    if(p_tape->encoding != TAPE_ABSOLUTE)
+    {
+        size += 1 + varintSize(p_tape->encoding);
+    }
+
+    if(p_tape->track_mask)
+    {
+        size += 1 + varintSize(p_tape->track_mask);
+    }
+
+    for(pb_size_t i = 0; i < p_tape->periods_count; i++)
+    {
+        size_t period_size = 0;
+
+        pb_get_encoded_size(&period_size, TapePeriod_fields, &p_tape->periods[i]);
+        size += submessageSize(period_size);
+    }
+
+    return size;
+}
+
+static size_t uplinkSizeLocked(void)
+{
+    size_t size = TIMESTAMP_FIELD_MAX_SIZE;
+
+    for(int i = 0; i < TAPE_COUNT; i++)
+    {
+        // Only the Tapes with columns are encoded
+        if(tapes[i].columns_count > 0)
+        {
+            size += submessageSize(tapeSizeLocked(i));
+        }
+    }
+
+    return size;
+}
+
+static bool encodeColumns(pb_ostream_t *stream, const pb_field_iter_t *field, void *const *arg)
+{
+    const Tape *p_tape        = *arg;
+    uint8_t i_tape            = p_tape - tapes;
+    const int32_t *p_previous = NULL;
+    TapeColumn column;
+
+    for(pb_size_t i = 0; i < pool_count; i++)
+    {
+        if(column_tape[i] != i_tape)
+        {
+            continue;
+        }
+
+        fillColumn(p_tape, column_pool[i], p_previous, &column);
+        if(!pb_encode_tag_for_field(stream, field) ||
+           !pb_encode_submessage(stream, TapeColumn_fields, &column))
+        {
+            return false;
+        }
+        p_previous = column_pool[i];
+    }
+
+    return true;
+}
+
+static bool decodeColumn(pb_istream_t *stream, const pb_field_iter_t *field, void **arg)
+{
+    TapeDecodeContext *p_context = *arg;
+    const TapeData *p_data       = field->message;
+    TapeColumn column            = TapeColumn_init_zero;
+    uint32_t mask                = trackMask(p_data->TrackMask);
+    const int32_t *p_previous;
+    int32_t *p_values;
+    pb_size_t i_value = 0;
+
+    if(!pb_decode(stream, TapeColumn_fields, &column))
+    {
+        return false;
+    }
+
+    if(p_data->Index != p_context->i_tape)
+    {
+        // Column of a Tape that is not requested
+        return true;
+    }
+
+    if(p_context->columns_count >= p_context->max_columns)
+    {
+        return false;
+    }
+
+    p_values   = &p_context->p_columns[p_context->columns_count * MAX_TRACKS_COUNT];
+    p_previous = (p_context->columns_count > 0) ? p_values - MAX_TRACKS_COUNT : NULL;
+    memset(p_values, 0, MAX_TRACKS_COUNT * sizeof(int32_t));
+
+    for(int i = 0; i < MAX_TRACKS_COUNT; i++)
+    {
+        if(!(mask & BIT(i)))
+        {
+            continue;
+        }
+
+        if(column.TrackDelta_count > 0)
+        {
+            uint32_t previous = p_previous ? (uint32_t)p_previous[i] : 0;
+            uint32_t delta    = (i_value < column.TrackDelta_count)
+                                    ? (uint32_t)column.TrackDelta[i_value]
+                                    : 0;
+
+            p_values[i] = (int32_t)(previous + delta);
+        }
+        else if(i_value < column.Track_count)
+        {
+            p_values[i] = column.Track[i_value];
+        }
+        i_value++;
+    }
+
+    p_context->columns_count++;
+
+    return true;
+}
+
+static void rewindLocked(uint8_t i_tape)
+{
+    Tape *p_tape       = &tapes[i_tape];
+    pb_size_t i_target = 0;
+
+    if(p_tape->periods_count > 0)
+    {
+        p_tape->periods[0]           = p_tape->periods[p_tape->periods_count - 1];
+        p_tape->periods[0].Cindex    = 0;
+        p_tape->periods[0].Timestamp = getTimestamp();
+        p_tape->periods_count        = 1;
+    }
+
+    if(p_tape->columns_count > 0)
+    {
+        // Compact the pool keeping the column order of the other Tapes
+        for(pb_size_t i = 0; i < pool_count; i++)
+        {
+            if(column_tape[i] == i_tape)
+            {
+                continue;
+            }
+
+            if(i != i_target)
+            {
+                memcpy(column_pool[i_target], column_pool[i], sizeof(column_pool[0]));
+                column_tape[i_target] = column_tape[i];
+            }
+            i_target++;
+        }
+        pool_count = i_target;
+    }
+
+    p_tape->columns_count    = 0;
+    p_tape->columns_size     = 0;
+    p_tape->last_column_size = 0;
+}
+
+int tapeSetEncoding(uint8_t i_tape, TapeEncoding encoding)
+{
+    if(i_tape >= TAPE_COUNT || encoding < _TapeEncoding_MIN || encoding > _TapeEncoding_MAX)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    if(tapes[i_tape].encoding != encoding)
+    {
+        tapes[i_tape].encoding = encoding;
+        rewindLocked(i_tape);
+    }
+    k_mutex_unlock(&tape_mutex);
+
+    return 0;
+}
+
+TapeEncoding tapeGetEncoding(uint8_t i_tape)
+{
+    if(i_tape >= TAPE_COUNT)
+    {
+        return TAPE_ABSOLUTE;
+    }
+
+    return tapes[i_tape].encoding;
+}
+
+int tapeSetTrackMask(uint8_t i_tape, uint32_t mask)
+{
+    if(i_tape >= TAPE_COUNT || (mask & ~ALL_TRACKS_MASK))
+    {
+        return -EINVAL;
+    }
+
+    // All Tracks are sent without the mask
+    if(mask == ALL_TRACKS_MASK)
+    {
+        mask = 0;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    if(tapes[i_tape].track_mask != mask)
+    {
+        tapes[i_tape].track_mask = mask;
+        rewindLocked(i_tape);
+    }
+    k_mutex_unlock(&tape_mutex);
+
+    return 0;
+}
+
+int tapeSetColumnLimit(uint8_t i_tape, pb_size_t limit)
+{
+    if(i_tape >= TAPE_COUNT || limit > TAPE_MAX_COLUMNS_COUNT)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    tapes[i_tape].columns_limit = limit;
+    k_mutex_unlock(&tape_mutex);
+
+    return 0;
+}
+
+static pb_size_t columnLimit(const Tape *p_tape)
+{
+    return p_tape->columns_limit ? p_tape->columns_limit : TAPE_MAX_COLUMNS_COUNT;
+}
+
+static int updatePeriodLocked(Tape *p_tape, uint32_t value)
+{
+    TapePeriod *p_last = NULL;
+
+    if(p_tape->periods_count > 0)
+    {
+        p_last = &p_tape->periods[p_tape->periods_count - 1];
+        if(p_last->Value == value)
+        {
+            return 0;
+        }
+
+        if(p_last->Cindex == p_tape->columns_count)
+        {
+            // No measurements under the last period, overwrite it
+            p_last->Value     = value;
+            p_last->Timestamp = getTimestamp();
+            return 0;
+        }
+    }
+
+    if(p_tape->periods_count >= MAX_PERIODS_COUNT)
+    {
+        return -ENOSPC;
+    }
+
+    p_last            = &p_tape->periods[p_tape->periods_count++];
+    p_last->Timestamp = getTimestamp();
+    p_last->Value     = value;
+    p_last->Cindex    = p_tape->columns_count;
+
+    return 0;
+}
+
+int tapeUpdatePeriod(uint8_t i_tape, uint32_t value)
+{
+    int err;
+
+    if(i_tape >= TAPE_COUNT)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    err = updatePeriodLocked(&tapes[i_tape], value);
+    k_mutex_unlock(&tape_mutex);
+
+    return err;
+}
+
+int tapeAddColumn(uint8_t i_tape, uint32_t period, const int32_t *p_measurements)
+{
+    Tape *p_tape;
+    pb_size_t periods_count;
+    TapePeriod last_period;
+    size_t column_size;
+    size_t uplink_size;
+    int err;
+
+    if(i_tape >= TAPE_COUNT || p_measurements == NULL)
+    {
+        return -EINVAL;
+    }
+
+    p_tape = &tapes[i_tape];
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    if(pool_count >= TAPE_MAX_COLUMNS_COUNT || p_tape->columns_count >= columnLimit(p_tape))
+    {
+        k_mutex_unlock(&tape_mutex);
+        return -ENOSPC;
+    }
+
+    // Keep the Periods state to revert if the column does not fit
+    periods_count = p_tape->periods_count;
+    last_period   = p_tape->periods[MAX(periods_count, 1) - 1];
+
+    err = updatePeriodLocked(p_tape, period);
+    if(err)
+    {
+        k_mutex_unlock(&tape_mutex);
+        return err;
+    }
+
+    column_size = columnSize(p_tape, p_measurements);
+
+    p_tape->columns_size += column_size;
+    p_tape->columns_count++;
+    uplink_size = uplinkSizeLocked();
+    if(uplink_size > TAPE_PAYLOAD_MAX_SIZE)
+    {
+        p_tape->columns_count--;
+        p_tape->columns_size -= column_size;
+        p_tape->periods_count = periods_count;
+        if(periods_count > 0)
+        {
+            p_tape->periods[periods_count - 1] = last_period;
+        }
+        k_mutex_unlock(&tape_mutex);
+        return -ENOSPC;
+    }
+
+    memcpy(column_pool[pool_count], p_measurements, sizeof(column_pool[0]));
+    column_tape[pool_count] = i_tape;
+    pool_count++;
+    memcpy(p_tape->last, p_measurements, sizeof(p_tape->last));
+    p_tape->last_column_size = column_size;
+
+    // Assume the next columns are as large as this one
+    err = (int)MIN((TAPE_PAYLOAD_MAX_SIZE - uplink_size) / column_size,
+                   (size_t)(columnLimit(p_tape) - p_tape->columns_count));
+    err = MIN(err, TAPE_MAX_COLUMNS_COUNT - pool_count);
+    k_mutex_unlock(&tape_mutex);
+
+    return err;
+}
+
+pb_size_t tapeGetRecordsCount(uint8_t i_tape)
+{
+    if(i_tape >= TAPE_COUNT)
+    {
+        return 0;
+    }
+
+    return tapes[i_tape].columns_count;
+}
+
+size_t tapeGetEncodedSize(void)
+{
+    size_t size;
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    size = uplinkSizeLocked();
+    k_mutex_unlock(&tape_mutex);
+
+    return size;
+}
+
+bool tapeIsFull(uint8_t i_tape)
+{
+    bool full;
+
+    if(i_tape >= TAPE_COUNT)
+    {
+        return false;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    full = tapes[i_tape].columns_count >= columnLimit(&tapes[i_tape]);
+    k_mutex_unlock(&tape_mutex);
+
+    return full;
+}
+
+bool tapeIsUdpPacketFull(void)
+{
+    size_t next_column_size = 0;
+    bool full               = false;
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    for(int i = 0; i < TAPE_COUNT; i++)
+    {
+        if(tapes[i].columns_count >= columnLimit(&tapes[i]))
+        {
+            full = true;
+        }
+        next_column_size = MAX(next_column_size, tapes[i].last_column_size);
+    }
+
+    if(!full)
+    {
+        full = pool_count >= TAPE_MAX_COLUMNS_COUNT ||
+               (uplinkSizeLocked() + next_column_size) > TAPE_PAYLOAD_MAX_SIZE;
+    }
+    k_mutex_unlock(&tape_mutex);
+
+    return full;
+}
+
+void tapeRewind(uint8_t i_tape)
+{
+    if(i_tape >= TAPE_COUNT)
+    {
+        return;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    rewindLocked(i_tape);
+    k_mutex_unlock(&tape_mutex);
+}
+
+static int encodeLocked(uint8_t *p_buffer, size_t size, size_t *p_len)
+{
+    TapeUplink message  = TapeUplink_init_zero;
+    pb_ostream_t stream = pb_ostream_from_buffer(p_buffer, size);
+
+    message.Timestamp = getTimestamp();
+    for(int i = 0; i < TAPE_COUNT; i++)
+    {
+        TapeData *p_data;
+
+        if(tapes[i].columns_count == 0)
+        {
+            continue;
+        }
+
+        p_data                = &message.Tape[message.Tape_count++];
+        p_data->Index         = i;
+        p_data->Encoding      = tapes[i].encoding;
+        p_data->TrackMask     = tapes[i].track_mask;
+        p_data->Periods_count = tapes[i].periods_count;
+        memcpy(p_data->Periods, tapes[i].periods, sizeof(p_data->Periods));
+        p_data->Columns.funcs.encode = encodeColumns;
+        p_data->Columns.arg          = &tapes[i];
+    }
+
+    if(!pb_encode(&stream, TapeUplink_fields, &message))
+    {
+        return -ENOMEM;
+    }
+
+    *p_len = stream.bytes_written;
+
+    return 0;
+}
+
+int tapeEncode(uint8_t *p_buffer, size_t size, size_t *p_len)
+{
+    int err;
+
+    if(p_buffer == NULL || p_len == NULL)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    err = encodeLocked(p_buffer, size, p_len);
+    k_mutex_unlock(&tape_mutex);
+
+    return err;
+}
+
+int tapeDecode(const uint8_t *p_buffer, size_t len, uint8_t i_tape, int32_t *p_columns,
+               size_t max_columns)
+{
+    TapeUplink message        = TapeUplink_init_zero;
+    TapeDecodeContext context = {
+        .i_tape = i_tape, .p_columns = p_columns, .max_columns = max_columns};
+    pb_istream_t stream;
+
+    if(p_buffer == NULL || p_columns == NULL || i_tape >= TAPE_COUNT)
+    {
+        return -EINVAL;
+    }
+
+    // Callbacks of the static Tape array are kept while decoding
+    for(size_t i = 0; i < ARRAY_SIZE(message.Tape); i++)
+    {
+        message.Tape[i].Columns.funcs.decode = decodeColumn;
+        message.Tape[i].Columns.arg          = &context;
+    }
+
+    stream = pb_istream_from_buffer(p_buffer, len);
+    if(!pb_decode(&stream, TapeUplink_fields, &message))
+    {
+        return -EBADMSG;
+    }
+
+    return context.columns_count;
+}
+
+int tapeSubmit(bool upload)
+{
+    uint8_t *p_record;
+    size_t size;
+    size_t len = 0;
+    int err;
+
+    if(getUlDataMode() != RAW_DATA_MODE)
+    {
+        return -EPERM;
+    }
+
+    k_mutex_lock(&tape_mutex, K_FOREVER);
+    if(pool_count == 0)
+    {
+        k_mutex_unlock(&tape_mutex);
+        return -ENODATA;
+    }
+
+    // Encode in place, the record itself is handed to the mailer.
+    // The accounted size is an upper bound, the record shrinks on commit.
+    size     = MIN(uplinkSizeLocked(), (size_t)TAPE_PAYLOAD_MAX_SIZE);
+    p_record = uplinkQueueReserve(size);
+    if(p_record == NULL)
+    {
+        k_mutex_unlock(&tape_mutex);
+        return -ENOBUFS;
+    }
+
+    LATENCY_START(encode_start);
+    err = encodeLocked(p_record, size, &len);
+    LATENCY_STOP(LATENCY_TAPE_ENCODE, encode_start);
+    if(err)
+    {
+        uplinkQueueAbort();
+    }
+    else
+    {
+        uplinkQueueCommit(len);
+        for(int i = 0; i < TAPE_COUNT; i++)
+        {
+            rewindLocked(i);
+        }
+    }
+    k_mutex_unlock(&tape_mutex);
+
+    if(!err)
+    {
+        err = uplinkQueueSend(upload);
+        // Queued, handed over after the uplinks before it or once the network is up
+        if(err == -EBUSY || err == -EAGAIN)
+        {
+            err = 0;
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,401 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_uplink_compress.h"
+#include "lmt_latency.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+// Constants of the LZ4 block format
+#define MIN_MATCH     4
+#define LAST_LITERALS 5  // The block ends with at least 5 literals
+#define MF_LIMIT      12 // The last match starts at least 12 bytes before the end
+#define MAX_OFFSET    UINT16_MAX
+#define RUN_MASK      0x0F
+
+// Hash table of the last position of every 4 byte sequence, 2 bytes per entry
+#define HASH_LOG      10
+#define NO_POSITION   UINT16_MAX
+
+static const uint8_t *p_dictionary;
+static size_t dictionary_len;
+
+static uint16_t hash_table[BIT(HASH_LOG)];
+// hash_table state after the uplink dictionary, hashed once when it is set
+static uint16_t dictionary_table[BIT(HASH_LOG)];
+
+static K_MUTEX_DEFINE(compress_mutex);
+
+typedef struct
+{
+    const uint8_t *p_dict;
+    size_t dict_len;
+    const uint8_t *p_in;
+    size_t len; // Dictionary and input length
+    uint8_t *p_out;
+    size_t size;
+    size_t i_out;
+} CompressContext;
+
+// Positions run over the dictionary followed by the input
+static uint8_t byteAt(const CompressContext *p_context, size_t position)
+{
+    if(position < p_context->dict_len)
+    {
+        return p_context->p_dict[position];
+    }
+
+    return p_context->p_in[position - p_context->dict_len];
+}
+
+static uint32_t read32(const CompressContext *p_context, size_t position)
+{
+    return byteAt(p_context, position) | (byteAt(p_context, position + 1) << 8) |
+           (byteAt(p_context, position + 2) << 16) |
+           ((uint32_t)byteAt(p_context, position + 3) << 24);
+}
+
+static uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+static int putByte(CompressContext *p_context, uint8_t value)
+{
+    if(p_context->i_out >= p_context->size)
+    {
+        return -ENOMEM;
+    }
+    p_context->p_out[p_context->i_out++] = value;
+
+    return 0;
+}
+
+static int putLength(CompressContext *p_context, size_t length)
+{
+    int err = 0;
+
+    for(; !err && length >= 255; length -= 255)
+    {
+        err = putByte(p_context, 255);
+    }
+
+    return err ? err : putByte(p_context, length);
+}
+
+/**
+ * @brief Writes one sequence: literals and the match that follows them
+ *
+ * @param p_context the compression context
+ * @param anchor position of the first literal
+ * @param literals literal count
+ * @param offset match distance, 0 for the last sequence without a match
+ * @param match match length
+ * @return 0 on success, -ENOMEM if the output buffer is full
+ */
+static int putSequence(CompressContext *p_context, size_t anchor, size_t literals, size_t offset,
+                       size_t match)
+{
+    size_t match_code = offset ? match - MIN_MATCH : 0;
+    uint8_t token     = (MIN(literals, RUN_MASK) << 4) | MIN(match_code, RUN_MASK);
+    int err           = putByte(p_context, token);
+
+    if(!err && literals >= RUN_MASK)
+    {
+        err = putLength(p_context, literals - RUN_MASK);
+    }
+
+    if(!err && (p_context->size - p_context->i_out) < literals)
+    {
+        err = -ENOMEM;
+    }
+
+    if(!err)
+    {
+        // Literals are never in the dictionary
+        memcpy(&p_context->p_out[p_context->i_out], &p_context->p_in[anchor - p_context->dict_len],
+               literals);
+        p_context->i_out += literals;
+    }
+
+    if(!err && offset)
+    {
+        err = putByte(p_context, offset & 0xFF);
+        if(!err)
+        {
+            err = putByte(p_context, offset >> 8);
+        }
+
+        if(!err && match_code >= RUN_MASK)
+        {
+            err = putLength(p_context, match_code - RUN_MASK);
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @brief Fills a hash table with the positions of the dictionary sequences
+ *
+ * @param p_table pointer to the hash table
+ * @param p_dict pointer to the dictionary, NULL for none
+ * @param dict_len length of the dictionary
+ */
+static void hashDictionary(uint16_t *p_table, const uint8_t *p_dict, size_t dict_len)
+{
+    CompressContext context = {.p_dict = p_dict, .dict_len = p_dict ? dict_len : 0};
+
+    memset(p_table, 0xFF, sizeof(hash_table));
+    for(size_t position = 0; (position + MIN_MATCH) <= context.dict_len; position++)
+    {
+        p_table[hash(read32(&context, position))] = position;
+    }
+}
+
+int uplinkCompressSetDictionary(const uint8_t *p_dict, size_t len)
+{
+    if(len > UPLINK_COMPRESS_MAX_DICT_SIZE)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&compress_mutex, K_FOREVER);
+    p_dictionary   = p_dict;
+    dictionary_len = p_dict ? len : 0;
+    hashDictionary(dictionary_table, p_dictionary, dictionary_len);
+    k_mutex_unlock(&compress_mutex);
+
+    return 0;
+}
+
+/**
+ * @brief Compresses the data into one LZ4 block
+ *
+ * @param p_dict pointer to the dictionary, NULL for none
+ * @param dict_len length of the dictionary
+ * @param p_dict_table the hash table of the dictionary, NULL to hash it here
+ * @param p_in pointer to the data
+ * @param len length of the data
+ * @param p_out pointer to the output buffer
+ * @param size size of the output buffer
+ * @return length of the compressed data, -EINVAL on invalid parameters,
+ * -ENOMEM if the compressed data does not fit the output buffer
+ */
+static int compressLocked(const uint8_t *p_dict, size_t dict_len, const uint16_t *p_dict_table,
+                          const uint8_t *p_in, size_t len, uint8_t *p_out, size_t size)
+{
+    CompressContext context = {.p_dict = p_dict,
+                               .dict_len = p_dict ? dict_len : 0,
+                               .p_in = p_in,
+                               .p_out = p_out,
+                               .size = size};
+    size_t position;
+    size_t anchor;
+    int err = 0;
+
+    if(p_in == NULL || p_out == NULL || len == 0 ||
+       context.dict_len > UPLINK_COMPRESS_MAX_DICT_SIZE)
+    {
+        return -EINVAL;
+    }
+
+    context.len = context.dict_len + len;
+    if(context.len >= NO_POSITION)
+    {
+        return -EINVAL;
+    }
+
+    if(p_dict_table != NULL)
+    {
+        memcpy(hash_table, p_dict_table, sizeof(hash_table));
+    }
+    else
+    {
+        hashDictionary(hash_table, p_dict, context.dict_len);
+    }
+
+    anchor   = context.dict_len;
+    position = context.dict_len;
+    while(!err && (position + MF_LIMIT) < context.len)
+    {
+        uint32_t sequence = read32(&context, position);
+        uint32_t i_hash   = hash(sequence);
+        size_t reference  = hash_table[i_hash];
+        size_t match      = MIN_MATCH;
+
+        hash_table[i_hash] = position;
+        if(reference == NO_POSITION || (position - reference) > MAX_OFFSET ||
+           read32(&context, reference) != sequence)
+        {
+            position++;
+            continue;
+        }
+
+        while((position + match) < (context.len - LAST_LITERALS) &&
+              byteAt(&context, reference + match) == byteAt(&context, position + match))
+        {
+            match++;
+        }
+
+        err      = putSequence(&context, anchor, position - anchor, position - reference, match);
+        position = position + match;
+        anchor   = position;
+    }
+
+    if(!err)
+    {
+        err = putSequence(&context, anchor, context.len - anchor, 0, 0);
+    }
+
+    return err ? err : (int)context.i_out;
+}
+
+int uplinkCompress(const uint8_t *p_in, size_t len, uint8_t *p_out, size_t size)
+{
+    int ret;
+    LATENCY_START(compress_start);
+
+    k_mutex_lock(&compress_mutex, K_FOREVER);
+    ret = compressLocked(p_dictionary, dictionary_len, p_dictionary ? dictionary_table : NULL, p_in,
+                         len, p_out, size);
+    k_mutex_unlock(&compress_mutex);
+    LATENCY_STOP(LATENCY_UPLINK_COMPRESS, compress_start);
+
+    return ret;
+}
+
+int uplinkCompressWithDictionary(const uint8_t *p_dict, size_t dict_len, const uint8_t *p_in,
+                                 size_t len, uint8_t *p_out, size_t size)
+{
+    int ret;
+
+    k_mutex_lock(&compress_mutex, K_FOREVER);
+    ret = compressLocked(p_dict, dict_len, NULL, p_in, len, p_out, size);
+    k_mutex_unlock(&compress_mutex);
+
+    return ret;
+}
+
+static int getLength(const uint8_t *p_in, size_t len, size_t *p_i_in, size_t *p_length)
+{
+    uint8_t value;
+
+    do
+    {
+        if(*p_i_in >= len)
+        {
+            return -EBADMSG;
+        }
+        value      = p_in[(*p_i_in)++];
+        *p_length += value;
+    } while(value == 255);
+
+    return 0;
+}
+
+static int decompressLocked(const uint8_t *p_dict, size_t dict_len, const uint8_t *p_in,
+                            size_t len, uint8_t *p_out, size_t size)
+{
+    size_t i_in  = 0;
+    size_t i_out = 0;
+    int err      = 0;
+
+    if(p_in == NULL || p_out == NULL)
+    {
+        return -EINVAL;
+    }
+
+    dict_len = p_dict ? dict_len : 0;
+    while(!err && i_in < len)
+    {
+        uint8_t token   = p_in[i_in++];
+        size_t literals = token >> 4;
+        size_t match    = token & RUN_MASK;
+        size_t offset;
+
+        if(literals == RUN_MASK)
+        {
+            err = getLength(p_in, len, &i_in, &literals);
+        }
+
+        if(!err && (literals > (len - i_in) || literals > (size - i_out)))
+        {
+            err = -EBADMSG;
+        }
+
+        if(err)
+        {
+            break;
+        }
+        memcpy(&p_out[i_out], &p_in[i_in], literals);
+        i_in  += literals;
+        i_out += literals;
+
+        // The last sequence has no match
+        if(i_in == len)
+        {
+            break;
+        }
+
+        if((len - i_in) < 2)
+        {
+            err = -EBADMSG;
+            break;
+        }
+        offset = p_in[i_in] | (p_in[i_in + 1] << 8);
+        i_in  += 2;
+
+        if(match == RUN_MASK)
+        {
+            err = getLength(p_in, len, &i_in, &match);
+        }
+        match += MIN_MATCH;
+
+        if(!err && (offset == 0 || offset > (i_out + dict_len) || match > (size - i_out)))
+        {
+            err = -EBADMSG;
+        }
+
+        // Byte by byte, the match may overlap the bytes it produces
+        for(size_t i = 0; !err && i < match; i++, i_out++)
+        {
+            p_out[i_out] =
+                (offset > i_out) ? p_dict[dict_len - (offset - i_out)] : p_out[i_out - offset];
+        }
+    }
+
+    return err ? err : (int)i_out;
+}
+
+int uplinkDecompress(const uint8_t *p_in, size_t len, uint8_t *p_out, size_t size)
+{
+    int ret;
+
+    k_mutex_lock(&compress_mutex, K_FOREVER);
+    ret = decompressLocked(p_dictionary, dictionary_len, p_in, len, p_out, size);
+    k_mutex_unlock(&compress_mutex);
+
+    return ret;
+}
+
+int uplinkDecompressWithDictionary(const uint8_t *p_dict, size_t dict_len, const uint8_t *p_in,
+                                   size_t len, uint8_t *p_out, size_t size)
+{
+    // Decoding keeps no state, the lock only guards the uplink dictionary
+    return decompressLocked(p_dict, dict_len, p_in, len, p_out, size);
+}
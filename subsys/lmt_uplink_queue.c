@@ -0,0 +1,490 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_uplink_queue.h"
+#include "lmt_event_subscribe.h"
+#include "lmt_latency.h"
+#include "lmt_settings.h"
+#include "lmt_uplink_compress.h"
+#include "lmt_uplink_spill.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#define RAW_DATA_MODE 1
+
+// Records are stored as the protobuf framing of a repeated bytes field followed by
+// the payload: tag, then the length as a two byte varint. Records in a row are a
+// valid batch message as they are.
+#define RECORD_TAG            0x0A // Field 1, uplink as is
+#define RECORD_TAG_COMPRESSED 0x12 // Field 2, LZ4 block of the uplink
+// Tag that marks the rest of the ring as unused, the next record is at the start
+#define RECORD_WRAP 0x00
+
+BUILD_ASSERT(UPLINK_QUEUE_SIZE >= UPLINK_QUEUE_RECORD_HEAD_SIZE + UPLINK_QUEUE_MAX_LEN,
+             "Uplink queue does not fit the largest uplink");
+BUILD_ASSERT(UPLINK_QUEUE_MAX_LEN < BIT(14), "Uplink length does not fit the record head");
+
+#define RECORD_HEAD_SIZE UPLINK_QUEUE_RECORD_HEAD_SIZE
+
+#if defined(CONFIG_LMTSDK_UPLINK_QUEUE_BATCH)
+#define BATCH_MAX_RECORDS CONFIG_LMTSDK_UPLINK_QUEUE_BATCH_MAX
+#else
+#define BATCH_MAX_RECORDS 1
+#endif
+
+#if defined(CONFIG_LMTSDK_UPLINK_SPILL)
+#define SPILL_DRAIN_INTERVAL K_MSEC(CONFIG_LMTSDK_UPLINK_SPILL_DRAIN_INTERVAL_MS)
+#else
+#define SPILL_DRAIN_INTERVAL K_NO_WAIT
+#endif
+
+static uint8_t ring[UPLINK_QUEUE_SIZE];
+
+#if defined(CONFIG_LMTSDK_UPLINK_COMPRESS)
+static uint8_t compress_buffer[UPLINK_QUEUE_MAX_LEN];
+#endif
+
+static size_t i_head;       // Oldest record
+static size_t i_tail;       // Where the next record is written
+static size_t used;         // Bytes taken by the records and the skipped ring ends
+static size_t count;        // Committed records
+static size_t i_reserved;   // Record being written
+static size_t reserved;     // Payload size of the record being written, 0 if none
+static size_t in_flight;    // Oldest records handed to setRawData()
+static bool upload_pending; // Upload requested for the queued uplinks
+static bool network_down;   // Uplinks are held for the spill until EVENT_NETWORK_UP
+
+static K_MUTEX_DEFINE(queue_mutex);
+
+static void drainWorkFn(struct k_work *p_work);
+static K_WORK_DELAYABLE_DEFINE(drain_work, drainWorkFn);
+
+static uint16_t recordLen(size_t i_record)
+{
+    return (ring[i_record + 1] & 0x7F) | (ring[i_record + 2] << 7);
+}
+
+static void setRecordHead(size_t i_record, uint8_t tag, uint16_t len)
+{
+    // Non-minimal varint, so the head size does not depend on the length
+    ring[i_record]     = tag;
+    ring[i_record + 1] = 0x80 | (len & 0x7F);
+    ring[i_record + 2] = len >> 7;
+}
+
+static bool isRecord(size_t i_record)
+{
+    return (UPLINK_QUEUE_SIZE - i_record) >= RECORD_HEAD_SIZE &&
+           (ring[i_record] == RECORD_TAG || ring[i_record] == RECORD_TAG_COMPRESSED);
+}
+
+/**
+ * @brief Compresses the record payload in place if that makes it smaller
+ *
+ * @param i_record the record
+ * @param p_len pointer to the payload length, updated with the compressed length
+ * @return the record tag
+ */
+static uint8_t compressLocked(size_t i_record, size_t *p_len)
+{
+#if defined(CONFIG_LMTSDK_UPLINK_COMPRESS)
+    uint8_t *p_payload = &ring[i_record + RECORD_HEAD_SIZE];
+    // -ENOMEM when the LZ4 block is not smaller than the uplink
+    int len = uplinkCompress(p_payload, *p_len, compress_buffer, *p_len - 1);
+
+    if(len > 0)
+    {
+        memcpy(p_payload, compress_buffer, len);
+        *p_len = len;
+        return RECORD_TAG_COMPRESSED;
+    }
+#endif
+
+    return RECORD_TAG;
+}
+
+/**
+ * @brief Finds a contiguous place for a record at the tail, wrapping to the start
+ * of the ring when the end is too short. The skipped end is counted as used.
+ *
+ * @param need record size including the head
+ * @return true if the record fits
+ */
+static bool placeLocked(size_t need)
+{
+    if(count == 0)
+    {
+        // Nothing to keep, start over for the largest contiguous space
+        i_head = 0;
+        i_tail = 0;
+        used   = 0;
+    }
+
+    if(used == UPLINK_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    if(i_tail < i_head)
+    {
+        return (i_head - i_tail) >= need;
+    }
+
+    if((UPLINK_QUEUE_SIZE - i_tail) >= need)
+    {
+        return true;
+    }
+
+    if(i_head < need)
+    {
+        return false;
+    }
+
+    if(i_tail < UPLINK_QUEUE_SIZE)
+    {
+        ring[i_tail] = RECORD_WRAP;
+    }
+    used  += UPLINK_QUEUE_SIZE - i_tail;
+    i_tail = 0;
+
+    return true;
+}
+
+static void popLocked(void)
+{
+    size_t size = RECORD_HEAD_SIZE + recordLen(i_head);
+
+    count--;
+    if(count == 0)
+    {
+        i_head = i_tail;
+        used   = 0;
+        return;
+    }
+
+    i_head += size;
+    used   -= size;
+
+    // Skip the unused ring end
+    if(!isRecord(i_head))
+    {
+        used  -= UPLINK_QUEUE_SIZE - i_head;
+        i_head = 0;
+    }
+}
+
+/**
+ * @brief Moves the oldest uplink to the flash journal to make room for a newer one
+ *
+ * @return true if an uplink was moved
+ */
+static bool spillOldestLocked(void)
+{
+    // The oldest uplink may still be read by the mailer
+    if(!IS_ENABLED(CONFIG_LMTSDK_UPLINK_SPILL) || count == 0 || in_flight)
+    {
+        return false;
+    }
+
+    // The head goes along, it tells if the uplink is compressed
+    if(uplinkSpillAppend(&ring[i_head], RECORD_HEAD_SIZE + recordLen(i_head)))
+    {
+        return false;
+    }
+    popLocked();
+
+    return true;
+}
+
+static uint8_t *reserveLocked(size_t size)
+{
+    bool placed;
+
+    if(reserved || size == 0 || size > UPLINK_QUEUE_MAX_LEN)
+    {
+        return NULL;
+    }
+
+    do
+    {
+        placed = placeLocked(RECORD_HEAD_SIZE + size);
+    } while(!placed && spillOldestLocked());
+
+    if(!placed)
+    {
+        return NULL;
+    }
+
+    reserved   = size;
+    i_reserved = i_tail;
+
+    return &ring[i_reserved + RECORD_HEAD_SIZE];
+}
+
+static void appendLocked(size_t size)
+{
+    reserved = 0;
+    i_tail   = i_reserved + size;
+    used    += size;
+    count++;
+}
+
+static int commitLocked(size_t len)
+{
+    uint8_t tag;
+
+    if(!reserved || len > reserved)
+    {
+        return -EINVAL;
+    }
+
+    if(len == 0)
+    {
+        reserved = 0;
+        return 0;
+    }
+
+    tag = compressLocked(i_reserved, &len);
+    setRecordHead(i_reserved, tag, len);
+    appendLocked(RECORD_HEAD_SIZE + len);
+
+    return 0;
+}
+
+uint8_t *uplinkQueueReserve(size_t size)
+{
+    uint8_t *p_record;
+
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    p_record = reserveLocked(size);
+    k_mutex_unlock(&queue_mutex);
+
+    return p_record;
+}
+
+int uplinkQueueCommit(size_t len)
+{
+    int err;
+
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    err = commitLocked(len);
+    k_mutex_unlock(&queue_mutex);
+
+    return err;
+}
+
+void uplinkQueueAbort(void)
+{
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    reserved = 0;
+    k_mutex_unlock(&queue_mutex);
+}
+
+static int sendLocked(bool upload)
+{
+    uint8_t *p_data;
+    int err;
+
+    upload_pending |= upload;
+
+    if(in_flight)
+    {
+        return -EBUSY;
+    }
+
+    if(count == 0)
+    {
+        return -ENODATA;
+    }
+
+    if(IS_ENABLED(CONFIG_LMTSDK_UPLINK_SPILL) && network_down)
+    {
+        return -EAGAIN;
+    }
+
+    if(getUlDataMode() != RAW_DATA_MODE)
+    {
+        return -EPERM;
+    }
+
+    // in_flight is set first, the packer may report back before setRawData() returns
+    if(IS_ENABLED(CONFIG_LMTSDK_UPLINK_QUEUE_BATCH))
+    {
+        // Records in a row up to the ring end, heads included, make the batch message
+        size_t i_next = i_head;
+        size_t len    = 0;
+        size_t records;
+
+        for(records = 0; records < count && records < BATCH_MAX_RECORDS && isRecord(i_next);
+            records++)
+        {
+            size_t size = RECORD_HEAD_SIZE + recordLen(i_next);
+
+            if((len + size) > UPLINK_QUEUE_MSG_SIZE)
+            {
+                break;
+            }
+            len    += size;
+            i_next += size;
+        }
+
+        p_data    = &ring[i_head];
+        in_flight = records;
+        LATENCY_START(handover_start);
+        err = setRawData(p_data, len, upload_pending);
+        LATENCY_STOP(LATENCY_QUEUE_HANDOVER, handover_start);
+    }
+    else
+    {
+        p_data    = &ring[i_head + RECORD_HEAD_SIZE];
+        in_flight = 1;
+        LATENCY_START(handover_start);
+        err = setRawData(p_data, recordLen(i_head), upload_pending);
+        LATENCY_STOP(LATENCY_QUEUE_HANDOVER, handover_start);
+    }
+
+    if(err)
+    {
+        in_flight = 0;
+    }
+
+    return err;
+}
+
+int uplinkQueueSend(bool upload)
+{
+    int err;
+
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    err = sendLocked(upload);
+    k_mutex_unlock(&queue_mutex);
+
+    return err;
+}
+
+size_t uplinkQueueGetCount(void)
+{
+    size_t queued;
+
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    queued = count;
+    k_mutex_unlock(&queue_mutex);
+
+    return queued;
+}
+
+static void drainWorkFn(struct k_work *p_work)
+{
+    uint8_t *p_record;
+    int len;
+
+    ARG_UNUSED(p_work);
+
+    if(!IS_ENABLED(CONFIG_LMTSDK_UPLINK_SPILL))
+    {
+        return;
+    }
+
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    // Fresh uplinks go first, the journal is drained into an idle queue only
+    if(!network_down && !in_flight && count == 0)
+    {
+        // The journal keeps the whole record, head included
+        p_record = reserveLocked(UPLINK_QUEUE_MAX_LEN);
+        len      = -ENOBUFS;
+        if(p_record)
+        {
+            len = uplinkSpillPeek(&ring[i_reserved], RECORD_HEAD_SIZE + UPLINK_QUEUE_MAX_LEN);
+        }
+
+        if(len > RECORD_HEAD_SIZE && isRecord(i_reserved) &&
+           recordLen(i_reserved) == (len - RECORD_HEAD_SIZE))
+        {
+            appendLocked(len);
+            uplinkSpillPop();
+            sendLocked(true);
+        }
+        else if(p_record)
+        {
+            reserved = 0;
+            if(len > 0)
+            {
+                // Not a queue record, drop it
+                uplinkSpillPop();
+            }
+        }
+    }
+    k_mutex_unlock(&queue_mutex);
+}
+
+void uplinkQueueOnEvent(SomEvent event, void *p_data, int i_data)
+{
+    ARG_UNUSED(p_data);
+    ARG_UNUSED(i_data);
+
+    k_mutex_lock(&queue_mutex, K_FOREVER);
+    switch(event)
+    {
+        case EVENT_PACKER_DONE_OK:
+            if(in_flight)
+            {
+                for(; in_flight > 0; in_flight--)
+                {
+                    popLocked();
+                }
+                if(count == 0)
+                {
+                    upload_pending = false;
+                }
+                sendLocked(false);
+            }
+            break;
+        case EVENT_PACKING_FAILED:
+        case EVENT_ENQUEUE_FAILED:
+            if(in_flight)
+            {
+                // Keep the uplinks and drop the pointer held by the mailer
+                in_flight = 0;
+                cleanRawData();
+            }
+            break;
+        case EVENT_NETWORK_DOWN:
+            network_down = true;
+            break;
+        case EVENT_NETWORK_UP:
+            network_down = false;
+            sendLocked(false);
+            break;
+        default:
+            break;
+    }
+
+    // One journal uplink per interval while no fresh uplinks wait
+    if(IS_ENABLED(CONFIG_LMTSDK_UPLINK_SPILL) && !network_down && !in_flight && count == 0)
+    {
+        k_work_schedule(&drain_work, SPILL_DRAIN_INTERVAL);
+    }
+    k_mutex_unlock(&queue_mutex);
+}
+
+#if defined(CONFIG_LMTSDK_EVENT_SUBSCRIBE)
+SOM_EVENT_SUBSCRIBE(EVENT_PACKER_DONE_OK, uplinkQueueOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_PACKING_FAILED, uplinkQueueOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_ENQUEUE_FAILED, uplinkQueueOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_NETWORK_DOWN, uplinkQueueOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_NETWORK_UP, uplinkQueueOnEvent);
+#endif
@@ -0,0 +1,347 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_uplink_scheduler.h"
+#include "lmt_coap_manager.h"
+#include "lmt_event_subscribe.h"
+#include <errno.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_LTE_LC_CONN_EVAL_MODULE)
+#include <modem/lte_lc.h>
+
+BUILD_ASSERT(UPLINK_SCHEDULER_ESTIMATE_NORMAL == LTE_LC_ENERGY_CONSUMPTION_NORMAL,
+             "Energy estimate mismatch");
+#endif
+
+#define GOOD_RSRP        CONFIG_LMTSDK_UPLINK_SCHEDULER_GOOD_RSRP
+#define MIN_INTERVAL_S   CONFIG_LMTSDK_UPLINK_SCHEDULER_MIN_INTERVAL_S
+#define MAX_LATENCY_S    CONFIG_LMTSDK_UPLINK_SCHEDULER_MAX_LATENCY_S
+#define CHECK_INTERVAL_S CONFIG_LMTSDK_UPLINK_SCHEDULER_CHECK_INTERVAL_S
+// RSRP index of %CONEVAL to dBm, 0 is below -140 dBm
+#define CONN_EVAL_RSRP_OFFSET 140
+
+static bool started;
+static bool pending;
+static bool connected;
+static int64_t pending_since; // Uptime ms of the oldest pending request
+static int64_t sent_since;    // Uptime ms of the oldest request of the last send
+static UplinkSchedulerStats stats;
+
+static K_MUTEX_DEFINE(scheduler_mutex);
+
+// lte_lc_conn_eval_params_get() blocks on an AT command, kept off the system work queue
+static struct k_work_q scheduler_work_q;
+static K_THREAD_STACK_DEFINE(scheduler_stack, CONFIG_LMTSDK_UPLINK_SCHEDULER_STACK_SIZE);
+
+static void checkWorkFn(struct k_work *p_work);
+static K_WORK_DELAYABLE_DEFINE(check_work, checkWorkFn);
+
+static int uplinkSchedulerInit(void)
+{
+    struct k_work_queue_config config = {.name = "lmt_scheduler"};
+
+    k_work_queue_init(&scheduler_work_q);
+    k_work_queue_start(&scheduler_work_q, scheduler_stack, K_THREAD_STACK_SIZEOF(scheduler_stack),
+                       CONFIG_LMTSDK_UPLINK_SCHEDULER_PRIORITY, &config);
+
+    return 0;
+}
+
+SYS_INIT(uplinkSchedulerInit, APPLICATION, 0);
+
+static void scheduleCheckLocked(uint32_t delay_s)
+{
+    k_work_schedule_for_queue(&scheduler_work_q, &check_work, K_SECONDS(delay_s));
+}
+
+UplinkSchedulerDecision uplinkSchedulerDecide(int32_t rsrp, int energy_estimate,
+                                              uint32_t waited_s)
+{
+    bool good = true;
+
+    if(waited_s >= MAX_LATENCY_S)
+    {
+        return UPLINK_SCHEDULER_SEND_LATE;
+    }
+
+    if(waited_s < MIN_INTERVAL_S)
+    {
+        return UPLINK_SCHEDULER_WAIT;
+    }
+
+    if(rsrp != UPLINK_SCHEDULER_RSRP_UNKNOWN && rsrp < GOOD_RSRP)
+    {
+        good = false;
+    }
+
+    // The modem estimate includes the CE level and the repetitions the RSRP does not show
+    if(energy_estimate != UPLINK_SCHEDULER_ESTIMATE_UNKNOWN &&
+       energy_estimate < UPLINK_SCHEDULER_ESTIMATE_NORMAL)
+    {
+        good = false;
+    }
+
+    return good ? UPLINK_SCHEDULER_SEND_GOOD : UPLINK_SCHEDULER_WAIT;
+}
+
+/**
+ * @brief Reads the quality, from the connection evaluation or the library cache
+ *
+ * @return RSRP in dBm, UPLINK_SCHEDULER_RSRP_UNKNOWN if not known
+ */
+static int32_t readQuality(int *p_energy_estimate, bool *p_evaluated)
+{
+    int32_t rsrp;
+    int32_t rsrq;
+    int32_t snr;
+
+    *p_energy_estimate = UPLINK_SCHEDULER_ESTIMATE_UNKNOWN;
+    *p_evaluated       = false;
+
+#if defined(CONFIG_LTE_LC_CONN_EVAL_MODULE)
+    struct lte_lc_conn_eval_params params = {0};
+
+    // Positive results are evaluation failures of the modem, e.g. no cell or in PSM
+    if(lte_lc_conn_eval_params_get(&params) == 0)
+    {
+        *p_energy_estimate = params.energy_estimate;
+        *p_evaluated       = true;
+        return params.rsrp - CONN_EVAL_RSRP_OFFSET;
+    }
+#endif
+
+    if(getNetworkQuality(&rsrp, &rsrq, &snr) == 0)
+    {
+        return rsrp;
+    }
+
+    return UPLINK_SCHEDULER_RSRP_UNKNOWN;
+}
+
+static uint32_t waitedLocked(void)
+{
+    return (uint32_t)((k_uptime_get() - pending_since) / MSEC_PER_SEC);
+}
+
+/**
+ * @brief Marks the pending uplinks sent, the caller triggers the mailer after unlocking
+ */
+static void sendLocked(uint32_t *p_counter)
+{
+    (*p_counter)++;
+    stats.max_wait_s = MAX(stats.max_wait_s, waitedLocked());
+    sent_since       = pending_since;
+    pending          = false;
+    k_work_cancel_delayable(&check_work);
+}
+
+static void checkWorkFn(struct k_work *p_work)
+{
+    UplinkSchedulerDecision decision;
+    int energy_estimate;
+    bool evaluated;
+    bool send = false;
+    int32_t rsrp;
+    uint32_t waited;
+
+    ARG_UNUSED(p_work);
+
+    // The evaluation is an AT command, not taken under the lock
+    rsrp = readQuality(&energy_estimate, &evaluated);
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if(pending)
+    {
+        waited   = waitedLocked();
+        decision = uplinkSchedulerDecide(rsrp, energy_estimate, waited);
+
+        stats.last_rsrp = rsrp;
+        if(!evaluated)
+        {
+            stats.eval_failed++;
+        }
+
+        if(decision == UPLINK_SCHEDULER_SEND_GOOD)
+        {
+            sendLocked(&stats.good);
+            send = true;
+        }
+        else if(decision == UPLINK_SCHEDULER_SEND_LATE)
+        {
+            sendLocked(&stats.late);
+            send = true;
+        }
+        else if(waited < MIN_INTERVAL_S)
+        {
+            scheduleCheckLocked(MIN_INTERVAL_S - waited);
+        }
+        else
+        {
+            stats.deferred++;
+            scheduleCheckLocked(MIN(CHECK_INTERVAL_S, MAX_LATENCY_S - waited));
+        }
+    }
+    k_mutex_unlock(&scheduler_mutex);
+
+    if(send)
+    {
+        triggerMailer(false);
+    }
+}
+
+int uplinkSchedulerStart(void)
+{
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if(started)
+    {
+        k_mutex_unlock(&scheduler_mutex);
+        return -EALREADY;
+    }
+
+    started = true;
+    setMailerWaitMode(WAIT_FOREVER);
+    k_mutex_unlock(&scheduler_mutex);
+
+    return 0;
+}
+
+void uplinkSchedulerStop(void)
+{
+    bool send = false;
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if(started)
+    {
+        started = false;
+        if(pending)
+        {
+            sendLocked(&stats.urgent);
+            send = true;
+        }
+        k_work_cancel_delayable(&check_work);
+        setMailerWaitMode(WAIT_ON_TIMEOUT);
+    }
+    k_mutex_unlock(&scheduler_mutex);
+
+    if(send)
+    {
+        triggerMailer(false);
+    }
+}
+
+int uplinkSchedulerRequest(bool urgent)
+{
+    bool send = false;
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    if(!started)
+    {
+        k_mutex_unlock(&scheduler_mutex);
+        return -EPERM;
+    }
+
+    stats.requests++;
+    if(!pending)
+    {
+        pending       = true;
+        pending_since = k_uptime_get();
+        scheduleCheckLocked(MIN_INTERVAL_S);
+    }
+
+    if(urgent)
+    {
+        sendLocked(&stats.urgent);
+        send = true;
+    }
+    else if(connected)
+    {
+        sendLocked(&stats.piggybacked);
+        send = true;
+    }
+    k_mutex_unlock(&scheduler_mutex);
+
+    if(send)
+    {
+        triggerMailer(false);
+    }
+
+    return 0;
+}
+
+int uplinkSchedulerGetStats(UplinkSchedulerStats *p_stats)
+{
+    if(p_stats == NULL)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    *p_stats = stats;
+    k_mutex_unlock(&scheduler_mutex);
+
+    return 0;
+}
+
+void uplinkSchedulerOnEvent(SomEvent event, void *p_data, int i_data)
+{
+    bool send = false;
+
+    ARG_UNUSED(p_data);
+    ARG_UNUSED(i_data);
+
+    k_mutex_lock(&scheduler_mutex, K_FOREVER);
+    switch(event)
+    {
+        case EVENT_RRC_CONNECTED:
+            connected = true;
+            if(started && pending)
+            {
+                sendLocked(&stats.piggybacked);
+                send = true;
+            }
+            break;
+        case EVENT_RRC_IDLE:
+        case EVENT_NETWORK_DOWN:
+            connected = false;
+            break;
+        case EVENT_UL_MAX_RETRY:
+            // The uplink stays in the library queue, keep its age for the latency bound
+            if(started && !pending)
+            {
+                pending       = true;
+                pending_since = sent_since;
+                scheduleCheckLocked(CHECK_INTERVAL_S);
+            }
+            break;
+        default:
+            break;
+    }
+    k_mutex_unlock(&scheduler_mutex);
+
+    if(send)
+    {
+        triggerMailer(false);
+    }
+}
+
+#if defined(CONFIG_LMTSDK_EVENT_SUBSCRIBE)
+SOM_EVENT_SUBSCRIBE(EVENT_RRC_CONNECTED, uplinkSchedulerOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_RRC_IDLE, uplinkSchedulerOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_NETWORK_DOWN, uplinkSchedulerOnEvent);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_MAX_RETRY, uplinkSchedulerOnEvent);
+#endif
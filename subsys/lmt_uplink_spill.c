@@ -0,0 +1,628 @@
+/*
+ * Copyright 2026 Latvijas Mobilais Telefons
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lmt_uplink_spill.h"
+#include "lmt_filesystem.h"
+#include "lmt_latency.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+
+#define MOUNT_POINT DT_PROP(DT_NODELABEL(lfs1), mount_point)
+// Names for the lmt_filesystem.h API, relative to the LittleFS mount point
+#define JOURNAL_NAME      "uplink.jnl"
+#define COMPACT_NAME      "uplink.tmp"
+// Two copies of the read position, written in turns
+#define POSITION_NAME_0   "uplink.pa"
+#define POSITION_NAME_1   "uplink.pb"
+#define POSITION_TEXT_SIZE 48
+// fileWrite() takes text only, the binary records are written with the Zephyr fs API
+#define JOURNAL_PATH      MOUNT_POINT "/" JOURNAL_NAME
+#define COMPACT_PATH      MOUNT_POINT "/" COMPACT_NAME
+
+#define JOURNAL_MAGIC 0x4C4E4A55 // "UJNL"
+#define RECORD_MAGIC  0x4A55     // "UJ"
+
+// Size of the buffer the CRC is checked and the records are copied through
+#define SCAN_CHUNK_SIZE 64
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t generation; // Changed by every compaction
+} SpillJournalHead;
+
+typedef struct
+{
+    uint16_t magic;
+    uint16_t len;
+    uint32_t crc; // CRC32 (IEEE) of the payload
+} SpillRecordHead;
+
+/*
+ * Read position, kept as text in two files written in turns, so a torn write leaves the
+ * previous copy. A copy counts only with a good CRC and the generation of the journal,
+ * the journal starts over at its first record otherwise.
+ */
+typedef struct
+{
+    uint32_t seq;        // Write count, the newer good copy wins
+    uint32_t generation; // Journal generation the offset belongs to
+    uint32_t offset;     // Oldest record not removed yet
+    uint32_t crc;        // CRC32 (IEEE) of the fields above
+} SpillPosition;
+
+static bool opened;          // Journal checked after boot
+static uint32_t generation;  // Generation of the journal
+static uint32_t position_seq; // Sequence number of the last position written
+static size_t journal_size;  // Size of the valid records, head included
+static size_t read_offset;   // Oldest record not removed yet
+static size_t count;         // Records from read_offset on
+
+static K_MUTEX_DEFINE(spill_mutex);
+
+static uint32_t positionCrc(const SpillPosition *p_position)
+{
+    return crc32_ieee((const uint8_t *)p_position, offsetof(SpillPosition, crc));
+}
+
+/**
+ * @brief Reads one copy of the read position
+ *
+ * @param p_name the name of the copy
+ * @param p_position pointer to the position
+ * @return true if the copy is complete and its CRC is good
+ */
+static bool readPosition(const char *p_name, SpillPosition *p_position)
+{
+    char text[POSITION_TEXT_SIZE] = {0};
+    uint32_t *p_field             = &p_position->seq;
+    char *p_text                  = text;
+    int size                      = getFileSize(p_name);
+
+    if(size <= 0 || fileRead(p_name, text, sizeof(text) - 1, 0, size) <= 0)
+    {
+        return false;
+    }
+
+    // seq, generation, offset and crc in the order of SpillPosition
+    for(size_t i = 0; i < sizeof(*p_position) / sizeof(uint32_t); i++)
+    {
+        char *p_end;
+
+        p_field[i] = strtoul(p_text, &p_end, 10);
+        if(p_end == p_text)
+        {
+            return false;
+        }
+        p_text = p_end;
+    }
+
+    return p_position->crc == positionCrc(p_position);
+}
+
+static int writePositionLocked(void)
+{
+    SpillPosition position = {
+        .seq = position_seq + 1, .generation = generation, .offset = read_offset};
+    char text[POSITION_TEXT_SIZE];
+    int err;
+
+    position.crc = positionCrc(&position);
+    snprintk(text, sizeof(text), "%u %u %u %u", (unsigned int)position.seq,
+             (unsigned int)position.generation, (unsigned int)position.offset,
+             (unsigned int)position.crc);
+    err = fileOverwrite((position.seq & 1) ? POSITION_NAME_1 : POSITION_NAME_0, text);
+    if(err < 0)
+    {
+        return err;
+    }
+    position_seq = position.seq;
+
+    return 0;
+}
+
+static void dropLocked(void)
+{
+    // The journal goes first, positions left by a power cut are deleted at boot
+    deleteFile(JOURNAL_NAME);
+    deleteFile(POSITION_NAME_0);
+    deleteFile(POSITION_NAME_1);
+    journal_size = 0;
+    read_offset  = 0;
+    count        = 0;
+}
+
+/**
+ * @brief Reads and checks the record at the current file position
+ *
+ * @param p_file the open journal
+ * @param available bytes left in the journal from the current position
+ * @param p_buffer pointer to the payload buffer, NULL to only check the record
+ * @param size size of the payload buffer
+ * @return length of the payload, -EBADMSG if the record is torn or damaged,
+ * -ENOMEM if the buffer is too small
+ */
+static int readRecord(struct fs_file_t *p_file, size_t available, uint8_t *p_buffer, size_t size)
+{
+    SpillRecordHead head;
+    uint8_t chunk[SCAN_CHUNK_SIZE];
+    uint32_t crc = 0;
+
+    if(available < sizeof(head) || fs_read(p_file, &head, sizeof(head)) != sizeof(head) ||
+       head.magic != RECORD_MAGIC || head.len == 0 || head.len > available - sizeof(head))
+    {
+        return -EBADMSG;
+    }
+
+    if(p_buffer)
+    {
+        if(head.len > size)
+        {
+            return -ENOMEM;
+        }
+
+        if(fs_read(p_file, p_buffer, head.len) != head.len)
+        {
+            return -EBADMSG;
+        }
+        crc = crc32_ieee(p_buffer, head.len);
+    }
+    else
+    {
+        for(size_t done = 0; done < head.len;)
+        {
+            size_t part = MIN(sizeof(chunk), (size_t)(head.len - done));
+
+            if(fs_read(p_file, chunk, part) != (ssize_t)part)
+            {
+                return -EBADMSG;
+            }
+            crc   = crc32_ieee_update(crc, chunk, part);
+            done += part;
+        }
+    }
+
+    return (crc == head.crc) ? head.len : -EBADMSG;
+}
+
+/**
+ * @brief Picks the read position of the journal from the newer good copy of the current
+ * generation, the first record without one
+ *
+ * @param size the size of the journal
+ */
+static void loadPositionLocked(size_t size)
+{
+    SpillPosition positions[2];
+    bool valid[2];
+
+    valid[0] = readPosition(POSITION_NAME_0, &positions[0]);
+    valid[1] = readPosition(POSITION_NAME_1, &positions[1]);
+
+    read_offset  = sizeof(SpillJournalHead);
+    position_seq = 0;
+    for(size_t i = 0; i < ARRAY_SIZE(positions); i++)
+    {
+        const SpillPosition *p_position = &positions[i];
+
+        if(!valid[i] || p_position->generation != generation ||
+           p_position->offset < sizeof(SpillJournalHead) || p_position->offset > size)
+        {
+            continue;
+        }
+
+        if(position_seq == 0 || (int32_t)(p_position->seq - position_seq) > 0)
+        {
+            position_seq = p_position->seq;
+            read_offset  = p_position->offset;
+        }
+    }
+}
+
+/**
+ * @brief Finds the valid records after boot and cuts off a torn tail
+ *
+ * @return 0 on success, negative errno code on fail
+ */
+static int openLocked(void)
+{
+    SpillJournalHead head;
+    struct fs_file_t file;
+    size_t offset;
+    int size;
+    int err;
+
+    if(opened)
+    {
+        return 0;
+    }
+
+    // Left by a power cut during a compaction, the journal is still whole
+    deleteFile(COMPACT_NAME);
+
+    size = getFileSize(JOURNAL_NAME);
+    if(size <= 0)
+    {
+        dropLocked();
+        opened = true;
+        return 0;
+    }
+
+    fs_file_t_init(&file);
+    err = fs_open(&file, JOURNAL_PATH, FS_O_RDWR);
+    if(err)
+    {
+        return err;
+    }
+
+    if(fs_read(&file, &head, sizeof(head)) != sizeof(head) || head.magic != JOURNAL_MAGIC)
+    {
+        // Torn when it was created, no record made it
+        fs_close(&file);
+        dropLocked();
+        opened = true;
+        return 0;
+    }
+    generation = head.generation;
+    loadPositionLocked(size);
+
+    // The scan starts at a checked position, so the cut is at a record boundary
+    offset = read_offset;
+    err    = fs_seek(&file, offset, FS_SEEK_SET);
+    while(!err && offset < (size_t)size)
+    {
+        int len = readRecord(&file, size - offset, NULL, 0);
+
+        if(len < 0)
+        {
+            break;
+        }
+        offset += sizeof(SpillRecordHead) + len;
+        count++;
+    }
+
+    if(!err && offset < (size_t)size)
+    {
+        // Torn record of a power cut
+        err = fs_truncate(&file, offset);
+    }
+    fs_close(&file);
+
+    if(err)
+    {
+        count = 0;
+        return err;
+    }
+
+    opened       = true;
+    journal_size = offset;
+    if(count == 0)
+    {
+        dropLocked();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Creates the journal with its head
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+static int createLocked(void)
+{
+    SpillJournalHead head = {.magic = JOURNAL_MAGIC, .generation = generation + 1};
+    struct fs_file_t file;
+    int err;
+
+    fs_file_t_init(&file);
+    err = fs_open(&file, JOURNAL_PATH, FS_O_CREATE | FS_O_WRITE);
+    if(err)
+    {
+        return err;
+    }
+
+    if(fs_write(&file, &head, sizeof(head)) != sizeof(head))
+    {
+        err = -EIO;
+    }
+
+    if(fs_close(&file) && !err)
+    {
+        err = -EIO;
+    }
+
+    if(err)
+    {
+        deleteFile(JOURNAL_NAME);
+        return err;
+    }
+
+    generation   = head.generation;
+    journal_size = sizeof(head);
+    read_offset  = sizeof(head);
+
+    return 0;
+}
+
+/**
+ * @brief Copies the records not removed yet to a new journal of the next generation,
+ * which replaces the old one by a rename. A power cut before the rename keeps the old
+ * journal, one after it finds positions of the old generation only and starts at the
+ * first record of the new one.
+ *
+ * @return 0 on success, negative errno code of the file system on fail
+ */
+static int compactLocked(void)
+{
+    SpillJournalHead head = {.magic = JOURNAL_MAGIC, .generation = generation + 1};
+    struct fs_file_t from;
+    struct fs_file_t to;
+    uint8_t chunk[SCAN_CHUNK_SIZE];
+    int err;
+
+    fs_file_t_init(&from);
+    fs_file_t_init(&to);
+    err = fs_open(&from, JOURNAL_PATH, FS_O_READ);
+    if(err)
+    {
+        return err;
+    }
+
+    deleteFile(COMPACT_NAME);
+    err = fs_open(&to, COMPACT_PATH, FS_O_CREATE | FS_O_WRITE);
+    if(err)
+    {
+        fs_close(&from);
+        return err;
+    }
+
+    err = fs_seek(&from, read_offset, FS_SEEK_SET);
+    if(!err && fs_write(&to, &head, sizeof(head)) != sizeof(head))
+    {
+        err = -EIO;
+    }
+
+    for(size_t done = read_offset; !err && done < journal_size;)
+    {
+        size_t part = MIN(sizeof(chunk), journal_size - done);
+
+        if(fs_read(&from, chunk, part) != (ssize_t)part ||
+           fs_write(&to, chunk, part) != (ssize_t)part)
+        {
+            err = -EIO;
+        }
+        done += part;
+    }
+    fs_close(&from);
+
+    // Closing syncs the copy before it replaces the journal
+    if(fs_close(&to) && !err)
+    {
+        err = -EIO;
+    }
+
+    if(!err)
+    {
+        err = fs_rename(COMPACT_PATH, JOURNAL_PATH);
+    }
+
+    if(err)
+    {
+        deleteFile(COMPACT_NAME);
+        return err;
+    }
+
+    generation    = head.generation;
+    journal_size -= read_offset - sizeof(head);
+    read_offset   = sizeof(head);
+
+    // Optional, a missing position of this generation means the first record as well
+    writePositionLocked();
+
+    return 0;
+}
+
+int uplinkSpillAppend(const uint8_t *p_data, size_t len)
+{
+    SpillRecordHead head;
+    struct fs_file_t file;
+    int err;
+
+    if(p_data == NULL || len == 0 || len > UINT16_MAX)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&spill_mutex, K_FOREVER);
+    LATENCY_START(write_start);
+    err = openLocked();
+    if(!err && journal_size == 0)
+    {
+        err = createLocked();
+    }
+
+    // The removed records are compacted away once the journal would grow past the limit
+    if(!err && (journal_size + sizeof(head) + len) > UPLINK_SPILL_MAX_SIZE &&
+       read_offset > sizeof(SpillJournalHead))
+    {
+        err = compactLocked();
+    }
+
+    if(!err && (journal_size + sizeof(head) + len) > UPLINK_SPILL_MAX_SIZE)
+    {
+        err = -ENOSPC;
+    }
+
+    if(!err)
+    {
+        head.magic = RECORD_MAGIC;
+        head.len   = len;
+        head.crc   = crc32_ieee(p_data, len);
+
+        fs_file_t_init(&file);
+        err = fs_open(&file, JOURNAL_PATH, FS_O_WRITE | FS_O_APPEND);
+    }
+
+    if(!err)
+    {
+        if(fs_write(&file, &head, sizeof(head)) != sizeof(head) ||
+           fs_write(&file, p_data, len) != (ssize_t)len)
+        {
+            // Same as the recovery after a power cut
+            fs_truncate(&file, journal_size);
+            err = -EIO;
+        }
+
+        // Closing syncs the record to flash
+        if(fs_close(&file) && !err)
+        {
+            err = -EIO;
+        }
+    }
+    LATENCY_STOP(LATENCY_SPILL_WRITE, write_start);
+
+    if(!err)
+    {
+        journal_size += sizeof(head) + len;
+        count++;
+    }
+    else if(count == 0)
+    {
+        dropLocked();
+    }
+    k_mutex_unlock(&spill_mutex);
+
+    return err;
+}
+
+int uplinkSpillPeek(uint8_t *p_buffer, size_t size)
+{
+    struct fs_file_t file;
+    int err;
+
+    if(p_buffer == NULL)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&spill_mutex, K_FOREVER);
+    err = openLocked();
+    if(!err && count == 0)
+    {
+        err = -ENODATA;
+    }
+
+    if(!err)
+    {
+        fs_file_t_init(&file);
+        err = fs_open(&file, JOURNAL_PATH, FS_O_READ);
+    }
+
+    if(!err)
+    {
+        err = fs_seek(&file, read_offset, FS_SEEK_SET);
+        if(!err)
+        {
+            err = readRecord(&file, journal_size - read_offset, p_buffer, size);
+        }
+        fs_close(&file);
+
+        if(err == -EBADMSG)
+        {
+            dropLocked();
+        }
+    }
+    k_mutex_unlock(&spill_mutex);
+
+    return err;
+}
+
+int uplinkSpillPop(void)
+{
+    SpillRecordHead head;
+    struct fs_file_t file;
+    int err;
+
+    k_mutex_lock(&spill_mutex, K_FOREVER);
+    err = openLocked();
+    if(!err && count == 0)
+    {
+        err = -ENODATA;
+    }
+
+    if(!err)
+    {
+        fs_file_t_init(&file);
+        err = fs_open(&file, JOURNAL_PATH, FS_O_READ);
+    }
+
+    if(!err)
+    {
+        err = fs_seek(&file, read_offset, FS_SEEK_SET);
+        if(!err && fs_read(&file, &head, sizeof(head)) != sizeof(head))
+        {
+            err = -EIO;
+        }
+        fs_close(&file);
+    }
+
+    if(!err)
+    {
+        read_offset += sizeof(head) + head.len;
+        count--;
+        if(count == 0)
+        {
+            dropLocked();
+        }
+        else
+        {
+            err = writePositionLocked();
+        }
+    }
+    k_mutex_unlock(&spill_mutex);
+
+    return err;
+}
+
+size_t uplinkSpillGetCount(void)
+{
+    size_t records;
+
+    k_mutex_lock(&spill_mutex, K_FOREVER);
+    records = openLocked() ? 0 : count;
+    k_mutex_unlock(&spill_mutex);
+
+    return records;
+}
+
+#if defined(CONFIG_ZTEST)
+void uplinkSpillTestReboot(void)
+{
+    k_mutex_lock(&spill_mutex, K_FOREVER);
+    opened       = false;
+    generation   = 0;
+    position_seq = 0;
+    journal_size = 0;
+    read_offset  = 0;
+    count        = 0;
+    k_mutex_unlock(&spill_mutex);
+}
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * RFC 6298 estimator of the adaptive CoAP retransmission timeout (lmt_coap_rto.h).
+ * The exchanges are played with the CoAP events and sleeps, the response wait of the
+ * library is a fake that records what the estimator sets.
+ */
+
+#include "lmt_coap_rto.h"
+#include "lmt_settings.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define CONFIGURED_WAIT_S 10
+// Sleep granularity of the simulated clock
+#define RTT_TOLERANCE_MS  20
+
+static uint8_t library_wait_s;
+static uint32_t wait_sets;
+
+int setResponseWaitTimeout(uint8_t timeout)
+{
+    library_wait_s = timeout;
+    wait_sets++;
+
+    return 0;
+}
+
+uint8_t getResponseWaitTimeout(void)
+{
+    return library_wait_s;
+}
+
+static void exchange(uint32_t rtt_ms)
+{
+    coapRtoOnEvent(EVENT_COAP_START, NULL, 0);
+    k_msleep(rtt_ms);
+    coapRtoOnEvent(EVENT_COAP_OK, NULL, 0);
+}
+
+static void uplink(uint32_t rtt_ms)
+{
+    coapRtoOnEvent(EVENT_UL_START, NULL, 0);
+    exchange(rtt_ms);
+    coapRtoOnEvent(EVENT_UL_DONE, NULL, 0);
+}
+
+static CoapRtoStats getStats(void)
+{
+    CoapRtoStats stats = {0};
+
+    coapRtoGetStats(&stats);
+
+    return stats;
+}
+
+static void rtoBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    coapRtoReset();
+    library_wait_s = CONFIGURED_WAIT_S;
+    wait_sets      = 0;
+}
+
+ZTEST(coap_rto, test_configured_wait_until_sample)
+{
+    coapRtoOnEvent(EVENT_UL_START, NULL, 0);
+    coapRtoOnEvent(EVENT_COAP_START, NULL, 0);
+    zassert_equal(getStats().rto_ms, 0);
+    zassert_equal(wait_sets, 0);
+    zassert_equal(library_wait_s, CONFIGURED_WAIT_S);
+}
+
+ZTEST(coap_rto, test_first_sample)
+{
+    CoapRtoStats stats;
+
+    uplink(1000);
+    stats = getStats();
+
+    // SRTT = R, RTTVAR = R / 2, RTO = SRTT + max(G, 4 * RTTVAR)
+    zassert_equal(stats.samples, 1);
+    zassert_within(stats.srtt_ms, 1000, RTT_TOLERANCE_MS);
+    zassert_within(stats.rttvar_ms, 500, RTT_TOLERANCE_MS);
+    zassert_within(stats.rto_ms, 3000, 3 * RTT_TOLERANCE_MS);
+    zassert_equal(library_wait_s, DIV_ROUND_UP(stats.rto_ms, MSEC_PER_SEC));
+    zassert_equal(stats.wait_s, library_wait_s);
+}
+
+ZTEST(coap_rto, test_smoothing)
+{
+    CoapRtoStats stats;
+
+    uplink(1000);
+    uplink(1000);
+    stats = getStats();
+
+    // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+    zassert_equal(stats.samples, 2);
+    zassert_within(stats.srtt_ms, 1000, RTT_TOLERANCE_MS);
+    zassert_within(stats.rttvar_ms, 375, RTT_TOLERANCE_MS);
+    zassert_within(stats.rto_ms, 2500, 3 * RTT_TOLERANCE_MS);
+    zassert_true(stats.min_rtt_ms <= stats.max_rtt_ms);
+}
+
+ZTEST(coap_rto, test_wait_set_on_change_only)
+{
+    uplink(1000);
+    zassert_equal(wait_sets, 1);
+
+    // The RTO shrinks, but rounds up to the same whole second
+    uplink(1000);
+    uplink(1000);
+    zassert_equal(wait_sets, 1);
+}
+
+ZTEST(coap_rto, test_bounds)
+{
+    uplink(10);
+    zassert_equal(getStats().rto_ms, CONFIG_LMTSDK_COAP_RTO_MIN_S * MSEC_PER_SEC);
+    zassert_equal(library_wait_s, CONFIG_LMTSDK_COAP_RTO_MIN_S);
+
+    for(int i = 0; i < 8; i++)
+    {
+        coapRtoOnEvent(EVENT_COAP_NOACK, NULL, 0);
+    }
+    zassert_equal(getStats().rto_ms, CONFIG_LMTSDK_COAP_RTO_MAX_S * MSEC_PER_SEC);
+    zassert_equal(library_wait_s, CONFIG_LMTSDK_COAP_RTO_MAX_S);
+}
+
+ZTEST(coap_rto, test_timeout_backoff_and_karn)
+{
+    uint32_t rto_ms;
+
+    uplink(1000);
+    rto_ms = getStats().rto_ms;
+
+    coapRtoOnEvent(EVENT_UL_START, NULL, 0);
+    coapRtoOnEvent(EVENT_COAP_START, NULL, 0);
+    coapRtoOnEvent(EVENT_COAP_NOACK, NULL, 0);
+    zassert_equal(getStats().rto_ms, 2 * rto_ms);
+    zassert_equal(getStats().timeouts, 1);
+
+    // The ACK of the resend may belong to the first transmission, no sample
+    exchange(200);
+    zassert_equal(getStats().samples, 1);
+    zassert_equal(getStats().ambiguous, 1);
+    coapRtoOnEvent(EVENT_UL_DONE, NULL, 0);
+
+    // The next uplink samples again
+    uplink(1000);
+    zassert_equal(getStats().samples, 2);
+}
+
+ZTEST(coap_rto, test_reset_restores_wait)
+{
+    uplink(1000);
+    zassert_not_equal(library_wait_s, CONFIGURED_WAIT_S);
+
+    coapRtoReset();
+    zassert_equal(library_wait_s, CONFIGURED_WAIT_S);
+    zassert_equal(getStats().samples, 0);
+    zassert_equal(getStats().wait_s, 0);
+}
+
+ZTEST(coap_rto, test_format)
+{
+    char text[160];
+    int len;
+
+    uplink(1000);
+    len = coapRtoFormat(text, sizeof(text));
+    zassert_equal(len, strlen(text));
+    zassert_equal(strncmp(text, "rtt n=1 ", strlen("rtt n=1 ")), 0, "%s", text);
+
+    zassert_equal(coapRtoFormat(text, 8), 7);
+    zassert_equal(coapRtoFormat(NULL, 8), -EINVAL);
+}
+
+ZTEST_SUITE(coap_rto, NULL, NULL, rtoBefore, NULL, NULL);
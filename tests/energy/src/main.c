@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Modem energy and airtime ledger (lmt_energy.h). The modem, RRC, CoAP and uplink events
+ * are played with sleeps, the expected times are the uptime the sleeps took.
+ */
+
+#include "lmt_energy.h"
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define STEPS   100
+#define STEP_MS 20
+
+// Charge in microcoulombs of the connected and the idle milliseconds
+#define CHARGE_UC(connected_ms, idle_ms)                                                       \
+    (((uint64_t)(connected_ms) * ENERGY_CONNECTED_CURRENT_UA +                                 \
+      (uint64_t)(idle_ms) * ENERGY_IDLE_CURRENT_UA) /                                          \
+     MSEC_PER_SEC)
+
+// Sleeps and returns the uptime it took
+static uint32_t sleepMs(int32_t ms)
+{
+    int64_t start = k_uptime_get();
+
+    k_msleep(ms);
+
+    return (uint32_t)k_uptime_delta(&start);
+}
+
+static void energyBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    energyOnEvent(EVENT_MODEM_OFF, NULL, 0);
+    energyReset();
+}
+
+ZTEST(energy, test_no_uplink)
+{
+    EnergyLedger ledger;
+
+    zassert_equal(energyGetLast(&ledger), -ENODATA);
+    zassert_equal(energyGetLast(NULL), -EINVAL);
+    zassert_equal(energyGetTotals(NULL), -EINVAL);
+}
+
+ZTEST(energy, test_uplink)
+{
+    EnergyLedger ledger;
+    uint32_t idle_ms;
+    uint32_t setup_ms;
+    uint32_t coap_ms;
+    uint32_t ack_ms;
+    uint32_t tail_ms;
+    uint32_t off_ms;
+
+    energyOnEvent(EVENT_MODEM_ON, NULL, 0);
+    idle_ms = sleepMs(100);
+    energyOnEvent(EVENT_UL_START, NULL, 0);
+    energyOnEvent(EVENT_RRC_CONNECTED, NULL, 0);
+    setup_ms = sleepMs(200);
+    energyOnEvent(EVENT_COAP_START, NULL, 0);
+    coap_ms = sleepMs(300);
+    energyOnEvent(EVENT_COAP_OK, NULL, 0);
+    ack_ms = sleepMs(50);
+    energyOnEvent(EVENT_UL_DONE, NULL, 0);
+    // The RRC inactivity time counts in the totals only
+    tail_ms = sleepMs(400);
+    energyOnEvent(EVENT_RRC_IDLE, NULL, 0);
+    off_ms = sleepMs(150);
+    energyOnEvent(EVENT_MODEM_OFF, NULL, 0);
+    sleepMs(100);
+
+    zassert_ok(energyGetLast(&ledger));
+    zassert_equal(ledger.uplinks, 1);
+    zassert_equal(ledger.packets, 1);
+    zassert_equal(ledger.acked, 1);
+    zassert_equal(ledger.failed, 0);
+    zassert_equal(ledger.modem_on_ms, setup_ms + coap_ms + ack_ms);
+    zassert_equal(ledger.connected_ms, setup_ms + coap_ms + ack_ms);
+    zassert_equal(ledger.coap_ms, coap_ms);
+    zassert_equal(ledger.charge_uc, CHARGE_UC(setup_ms + coap_ms + ack_ms, 0));
+
+    zassert_ok(energyGetTotals(&ledger));
+    zassert_equal(ledger.uplinks, 1);
+    zassert_equal(ledger.modem_on_ms, idle_ms + setup_ms + coap_ms + ack_ms + tail_ms + off_ms);
+    zassert_equal(ledger.connected_ms, setup_ms + coap_ms + ack_ms + tail_ms);
+    zassert_equal(ledger.coap_ms, coap_ms);
+    zassert_equal(ledger.charge_uc,
+                  CHARGE_UC(setup_ms + coap_ms + ack_ms + tail_ms, idle_ms + off_ms));
+}
+
+ZTEST(energy, test_failed_uplink)
+{
+    EnergyLedger ledger;
+
+    energyOnEvent(EVENT_MODEM_ON, NULL, 0);
+    energyOnEvent(EVENT_UL_START, NULL, 0);
+    energyOnEvent(EVENT_COAP_START, NULL, 0);
+    sleepMs(100);
+    energyOnEvent(EVENT_COAP_NOACK, NULL, 0);
+    energyOnEvent(EVENT_UL_RETRY, NULL, 0);
+    energyOnEvent(EVENT_COAP_START, NULL, 0);
+    sleepMs(100);
+    energyOnEvent(EVENT_COAP_FAIL, NULL, 0);
+    energyOnEvent(EVENT_UL_MAX_RETRY, NULL, 0);
+
+    zassert_ok(energyGetLast(&ledger));
+    zassert_equal(ledger.uplinks, 1);
+    zassert_equal(ledger.failed, 1);
+    zassert_equal(ledger.retries, 1);
+    zassert_equal(ledger.packets, 2);
+    zassert_equal(ledger.acked, 0);
+}
+
+ZTEST(energy, test_charge_of_short_intervals)
+{
+    EnergyLedger ledger;
+    uint32_t on_ms = 0;
+
+    // Every event integrates a short interval, the charge is still the one of the sum
+    energyOnEvent(EVENT_MODEM_ON, NULL, 0);
+    for(int i = 0; i < STEPS; i++)
+    {
+        on_ms += sleepMs(STEP_MS);
+        energyOnEvent(EVENT_UL_RETRY, NULL, 0);
+    }
+
+    zassert_ok(energyGetTotals(&ledger));
+    zassert_equal(ledger.modem_on_ms, on_ms);
+    zassert_equal(ledger.connected_ms, 0);
+    zassert_equal(ledger.charge_uc, CHARGE_UC(0, on_ms));
+}
+
+ZTEST_SUITE(energy, NULL, NULL, energyBefore, NULL, NULL);
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Ordering, coalescing and data copies of the asynchronous event dispatch
+ * (lmt_event_queue.h). The dispatch thread runs below the test thread, so the
+ * queued events are only delivered when the test sleeps.
+ */
+
+#include "lmt_event_queue.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define LOG_LENGTH (EVENT_QUEUE_LENGTH + 1)
+#define DRAIN_MS   10
+
+typedef struct
+{
+    SomEvent event;
+    int i_data;
+    char data[8];
+} Delivery;
+
+static Delivery deliveries[LOG_LENGTH];
+static size_t delivery_count;
+// Network state the application believes, from the delivered events
+static bool network_up;
+
+static void record(SomEvent event, void *p_data, int i_data)
+{
+    Delivery *p_delivery;
+
+    if(delivery_count >= LOG_LENGTH)
+    {
+        return;
+    }
+
+    p_delivery          = &deliveries[delivery_count++];
+    p_delivery->event   = event;
+    p_delivery->i_data  = i_data;
+    p_delivery->data[0] = '\0';
+    if(p_data != NULL)
+    {
+        strncpy(p_delivery->data, p_data, sizeof(p_delivery->data) - 1);
+    }
+}
+
+void onUlStart(void *p_data, int i_data)
+{
+    record(EVENT_UL_START, p_data, i_data);
+}
+
+void onUlRetry(void *p_data, int i_data)
+{
+    record(EVENT_UL_RETRY, p_data, i_data);
+}
+
+void onNetworkUp(void *p_data, int i_data)
+{
+    network_up = true;
+    record(EVENT_NETWORK_UP, p_data, i_data);
+}
+
+void onNetworkDown(void *p_data, int i_data)
+{
+    network_up = false;
+    record(EVENT_NETWORK_DOWN, p_data, i_data);
+}
+
+void onLogInfo(void *p_data, int i_data)
+{
+    record(EVENT_LOG_INFO, p_data, i_data);
+}
+
+void onTerminalCmd(void *p_data, int i_data)
+{
+    record(EVENT_TERMINAL_CMD, p_data, i_data);
+}
+
+static void expectDeliveries(const SomEvent *p_events, size_t count)
+{
+    zassert_equal(delivery_count, count);
+    for(size_t i = 0; i < count; i++)
+    {
+        zassert_equal(deliveries[i].event, p_events[i], "delivery %zu", i);
+    }
+}
+
+static void eventQueueBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    k_msleep(DRAIN_MS);
+    delivery_count = 0;
+}
+
+ZTEST(event_queue, test_order)
+{
+    static const SomEvent order[] = {EVENT_UL_START, EVENT_NETWORK_UP, EVENT_UL_START};
+
+    eventQueuePost(EVENT_UL_START, NULL, 0);
+    eventQueuePost(EVENT_NETWORK_UP, NULL, 0);
+    eventQueuePost(EVENT_UL_START, NULL, 0);
+    zassert_equal(delivery_count, 0, "queued event delivered by the poster");
+
+    k_msleep(DRAIN_MS);
+    expectDeliveries(order, ARRAY_SIZE(order));
+}
+
+ZTEST(event_queue, test_coalesce_newest_only)
+{
+    static const SomEvent order[] = {EVENT_UL_RETRY, EVENT_UL_START, EVENT_UL_RETRY};
+    EventQueueStats before;
+    EventQueueStats after;
+
+    zassert_ok(eventQueueGetStats(&before));
+    // A retry behind another event must not jump ahead of it
+    eventQueuePost(EVENT_UL_RETRY, NULL, 1);
+    eventQueuePost(EVENT_UL_START, NULL, 0);
+    eventQueuePost(EVENT_UL_RETRY, NULL, 2);
+    // Merges into the newest record, which takes the latest data
+    eventQueuePost(EVENT_UL_RETRY, NULL, 3);
+
+    k_msleep(DRAIN_MS);
+    expectDeliveries(order, ARRAY_SIZE(order));
+    zassert_equal(deliveries[0].i_data, 1);
+    zassert_equal(deliveries[2].i_data, 3);
+    zassert_ok(eventQueueGetStats(&after));
+    zassert_equal(after.coalesced - before.coalesced, 1);
+}
+
+ZTEST(event_queue, test_terminal_cmd_copied)
+{
+    char command[] = "reboot";
+
+    eventQueuePost(EVENT_TERMINAL_CMD, command, strlen(command));
+    // The emitter owns the buffer only for the duration of the post
+    memset(command, 'x', strlen(command));
+    zassert_equal(delivery_count, 0);
+
+    k_msleep(DRAIN_MS);
+    zassert_equal(delivery_count, 1);
+    zassert_equal(deliveries[0].i_data, strlen("reboot"));
+    zassert_str_equal(deliveries[0].data, "reboot");
+}
+
+ZTEST(event_queue, test_unsized_data_direct)
+{
+    char text[] = "info";
+
+    // Data of no known length is not copied, the event is delivered at once
+    eventQueuePost(EVENT_LOG_INFO, text, 0);
+    zassert_equal(delivery_count, 1);
+    zassert_str_equal(deliveries[0].data, "info");
+}
+
+ZTEST(event_queue, test_set_dispatch)
+{
+    zassert_ok(eventQueueSetDispatch(EVENT_NETWORK_UP, EVENT_DISPATCH_DIRECT));
+    eventQueuePost(EVENT_NETWORK_UP, NULL, 0);
+    zassert_equal(delivery_count, 1);
+
+    zassert_ok(eventQueueSetDispatch(EVENT_NETWORK_UP, EVENT_DISPATCH_QUEUED));
+    eventQueuePost(EVENT_NETWORK_UP, NULL, 0);
+    zassert_equal(delivery_count, 1);
+    k_msleep(DRAIN_MS);
+    zassert_equal(delivery_count, 2);
+
+    zassert_equal(eventQueueSetDispatch(EVENT_COUNT, EVENT_DISPATCH_QUEUED), -EINVAL);
+}
+
+ZTEST(event_queue, test_up_then_down)
+{
+    static const SomEvent order[] = {EVENT_NETWORK_UP, EVENT_NETWORK_DOWN};
+
+    // Both queued by default, delivered in the order of the posts
+    eventQueuePost(EVENT_NETWORK_UP, NULL, 0);
+    eventQueuePost(EVENT_NETWORK_DOWN, NULL, 0);
+
+    k_msleep(DRAIN_MS);
+    expectDeliveries(order, ARRAY_SIZE(order));
+    zassert_false(network_up);
+}
+
+ZTEST(event_queue, test_direct_down_drops_pending_up)
+{
+    EventQueueStats before;
+    EventQueueStats after;
+
+    zassert_ok(eventQueueGetStats(&before));
+    zassert_ok(eventQueueSetDispatch(EVENT_NETWORK_DOWN, EVENT_DISPATCH_DIRECT));
+    eventQueuePost(EVENT_NETWORK_UP, NULL, 0);
+    eventQueuePost(EVENT_NETWORK_DOWN, NULL, 0);
+    zassert_ok(eventQueueSetDispatch(EVENT_NETWORK_DOWN, EVENT_DISPATCH_QUEUED));
+    zassert_equal(delivery_count, 1);
+    zassert_equal(deliveries[0].event, EVENT_NETWORK_DOWN);
+
+    // The stale EVENT_NETWORK_UP does not follow
+    k_msleep(DRAIN_MS);
+    zassert_equal(delivery_count, 1);
+    zassert_false(network_up);
+    zassert_ok(eventQueueGetStats(&after));
+    zassert_equal(after.superseded - before.superseded, 1);
+}
+
+ZTEST(event_queue, test_overflow_drops_pending_up)
+{
+    EventQueueStats before;
+    EventQueueStats after;
+
+    zassert_ok(eventQueueGetStats(&before));
+    eventQueuePost(EVENT_NETWORK_UP, NULL, 0);
+    for(size_t i = 1; i < EVENT_QUEUE_LENGTH; i++)
+    {
+        eventQueuePost(EVENT_UL_START, NULL, 0);
+    }
+    // The full queue hands the event back to the poster, ahead of the pending records
+    eventQueuePost(EVENT_NETWORK_DOWN, NULL, 0);
+    zassert_equal(delivery_count, 1);
+    zassert_equal(deliveries[0].event, EVENT_NETWORK_DOWN);
+
+    k_msleep(DRAIN_MS);
+    zassert_equal(delivery_count, EVENT_QUEUE_LENGTH);
+    for(size_t i = 1; i < delivery_count; i++)
+    {
+        zassert_equal(deliveries[i].event, EVENT_UL_START, "delivery %zu", i);
+    }
+    zassert_false(network_up);
+    zassert_ok(eventQueueGetStats(&after));
+    zassert_equal(after.overflows - before.overflows, 1);
+    zassert_equal(after.superseded - before.superseded, 1);
+    zassert_equal(after.max_depth, EVENT_QUEUE_LENGTH);
+}
+
+ZTEST_SUITE(event_queue, NULL, NULL, eventQueueBefore, NULL, NULL);
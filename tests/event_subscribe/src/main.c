@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Link time subscribers (lmt_event_subscribe.h): somEventPublish() calls the subscribers
+ * of the event, then the subscribers of every event, then the on<EventName>() callback,
+ * and passes the event data to each of them.
+ */
+
+#include "lmt_event_subscribe.h"
+#include <zephyr/ztest.h>
+
+#define LOG_LENGTH 8
+
+typedef enum
+{
+    CALLER_FIRST,   // Subscriber of EVENT_COAP_OK and EVENT_UL_DONE
+    CALLER_SECOND,  // Subscriber of EVENT_COAP_OK
+    CALLER_ALL,     // Subscriber of every event
+    CALLER_ON_COAP, // onCoapOk() of the application
+} Caller;
+
+typedef struct
+{
+    Caller caller;
+    SomEvent event;
+    void *p_data;
+    int i_data;
+} Call;
+
+static Call calls[LOG_LENGTH];
+static size_t call_count;
+
+static void record(Caller caller, SomEvent event, void *p_data, int i_data)
+{
+    if(call_count < LOG_LENGTH)
+    {
+        calls[call_count++] = (Call){caller, event, p_data, i_data};
+    }
+}
+
+static void firstSubscriber(SomEvent event, void *p_data, int i_data)
+{
+    record(CALLER_FIRST, event, p_data, i_data);
+}
+
+static void secondSubscriber(SomEvent event, void *p_data, int i_data)
+{
+    record(CALLER_SECOND, event, p_data, i_data);
+}
+
+static void allSubscriber(SomEvent event, void *p_data, int i_data)
+{
+    record(CALLER_ALL, event, p_data, i_data);
+}
+
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_OK, firstSubscriber);
+SOM_EVENT_SUBSCRIBE(EVENT_COAP_OK, secondSubscriber);
+SOM_EVENT_SUBSCRIBE(EVENT_UL_DONE, firstSubscriber);
+SOM_EVENT_SUBSCRIBE_ALL(allSubscriber);
+
+void onCoapOk(void *p_data, int i_data)
+{
+    record(CALLER_ON_COAP, EVENT_COAP_OK, p_data, i_data);
+}
+
+static void expectCall(size_t index, Caller caller, SomEvent event, void *p_data, int i_data)
+{
+    zassert_true(index < call_count, "call %zu missing", index);
+    zassert_equal(calls[index].caller, caller, "call %zu", index);
+    zassert_equal(calls[index].event, event, "call %zu", index);
+    zassert_equal_ptr(calls[index].p_data, p_data, "call %zu", index);
+    zassert_equal(calls[index].i_data, i_data, "call %zu", index);
+}
+
+static void subscribeBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    call_count = 0;
+}
+
+ZTEST(event_subscribe, test_order)
+{
+    static char data[] = "ok";
+
+    somEventPublish(EVENT_COAP_OK, data, 7);
+
+    zassert_equal(call_count, 4);
+    // Subscribers of the same event come in the link order of the section
+    zassert_true((calls[0].caller == CALLER_FIRST && calls[1].caller == CALLER_SECOND) ||
+                 (calls[0].caller == CALLER_SECOND && calls[1].caller == CALLER_FIRST));
+    expectCall(0, calls[0].caller, EVENT_COAP_OK, data, 7);
+    expectCall(1, calls[1].caller, EVENT_COAP_OK, data, 7);
+    expectCall(2, CALLER_ALL, EVENT_COAP_OK, data, 7);
+    expectCall(3, CALLER_ON_COAP, EVENT_COAP_OK, data, 7);
+}
+
+ZTEST(event_subscribe, test_callback_of_two_events)
+{
+    // No onUlDone() is linked, its slot is NULL
+    somEventPublish(EVENT_UL_DONE, NULL, -1);
+
+    zassert_equal(call_count, 2);
+    expectCall(0, CALLER_FIRST, EVENT_UL_DONE, NULL, -1);
+    expectCall(1, CALLER_ALL, EVENT_UL_DONE, NULL, -1);
+}
+
+ZTEST(event_subscribe, test_only_every_event_subscriber)
+{
+    somEventPublish(EVENT_MODEM_ON, NULL, 0);
+
+    zassert_equal(call_count, 1);
+    expectCall(0, CALLER_ALL, EVENT_MODEM_ON, NULL, 0);
+}
+
+ZTEST(event_subscribe, test_out_of_range)
+{
+    somEventPublish(EVENT_COUNT, NULL, 0);
+
+    zassert_equal(call_count, 0);
+}
+
+ZTEST_SUITE(event_subscribe, NULL, NULL, subscribeBefore, NULL, NULL);
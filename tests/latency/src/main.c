@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Latency histograms (lmt_latency.h) of known durations recorded with latencyRecord():
+ * the bucket of a duration, the percentile bounds, the max clamp and the text of
+ * latencyFormat() cut to the buffer.
+ */
+
+#include "lmt_latency.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#define FORMAT_SIZE 256
+
+/**
+ * @brief Records one duration on an empty probe and checks the bucket it lands in
+ *
+ * @param us the duration in microseconds
+ * @param i_bucket the bucket expected
+ */
+static void expectBucket(uint32_t us, size_t i_bucket)
+{
+    LatencyHistogram histogram;
+
+    latencyReset();
+    latencyRecord(LATENCY_TAPE_ENCODE, us);
+    zassert_ok(latencyGet(LATENCY_TAPE_ENCODE, &histogram));
+    zassert_equal(histogram.count, 1);
+    zassert_equal(histogram.buckets[i_bucket], 1, "%u us not in bucket %zu", us, i_bucket);
+}
+
+static void latencyBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    latencyReset();
+}
+
+ZTEST(latency, test_buckets)
+{
+    // Bucket i counts durations below 2^i us
+    expectBucket(0, 0);
+    expectBucket(1, 1);
+    expectBucket(2, 2);
+    expectBucket(3, 2);
+    expectBucket(4, 3);
+    expectBucket(1023, 10);
+    expectBucket(1024, 11);
+    expectBucket(BIT(LATENCY_BUCKET_COUNT - 2) - 1, LATENCY_BUCKET_COUNT - 2);
+    // The last bucket counts everything longer
+    expectBucket(BIT(LATENCY_BUCKET_COUNT - 2), LATENCY_BUCKET_COUNT - 1);
+    expectBucket(UINT32_MAX, LATENCY_BUCKET_COUNT - 1);
+}
+
+ZTEST(latency, test_totals)
+{
+    LatencyHistogram histogram;
+
+    latencyRecord(LATENCY_COAP, 100);
+    latencyRecord(LATENCY_COAP, 300);
+    latencyRecord(LATENCY_COAP, 200);
+
+    zassert_ok(latencyGet(LATENCY_COAP, &histogram));
+    zassert_equal(histogram.count, 3);
+    zassert_equal(histogram.total_us, 600);
+    zassert_equal(histogram.max_us, 300);
+
+    zassert_equal(latencyGet(LATENCY_PROBE_COUNT, &histogram), -EINVAL);
+    zassert_equal(latencyGet(LATENCY_COAP, NULL), -EINVAL);
+}
+
+ZTEST(latency, test_percentiles)
+{
+    LatencyHistogram histogram;
+
+    // 90 fast samples in the bucket below 128 us, 10 slow ones below 8192 us
+    for(int i = 0; i < 90; i++)
+    {
+        latencyRecord(LATENCY_UPLINK, 100);
+    }
+    for(int i = 0; i < 10; i++)
+    {
+        latencyRecord(LATENCY_UPLINK, 5000);
+    }
+    zassert_ok(latencyGet(LATENCY_UPLINK, &histogram));
+
+    // The bound is the upper end of the bucket, never below the sample
+    zassert_equal(latencyPercentile(&histogram, 50), 128);
+    zassert_equal(latencyPercentile(&histogram, 90), 128);
+    // The slow bucket ends at 8192 us, clamped to the max
+    zassert_equal(latencyPercentile(&histogram, 91), 5000);
+    zassert_equal(latencyPercentile(&histogram, 99), 5000);
+    zassert_equal(latencyPercentile(&histogram, 100), 5000);
+}
+
+ZTEST(latency, test_percentile_clamp)
+{
+    LatencyHistogram histogram = {0};
+
+    zassert_equal(latencyPercentile(&histogram, 50), 0);
+    zassert_equal(latencyPercentile(NULL, 50), 0);
+
+    // A lone sample of 100 us is in the bucket up to 128 us
+    latencyRecord(LATENCY_PACKER, 100);
+    zassert_ok(latencyGet(LATENCY_PACKER, &histogram));
+    zassert_equal(latencyPercentile(&histogram, 50), 100);
+    zassert_equal(latencyPercentile(&histogram, 99), 100);
+
+    // Samples of the last bucket have no upper end but the max
+    latencyRecord(LATENCY_PACKER, UINT32_MAX);
+    zassert_ok(latencyGet(LATENCY_PACKER, &histogram));
+    zassert_equal(latencyPercentile(&histogram, 99), UINT32_MAX);
+}
+
+ZTEST(latency, test_format)
+{
+    static char text[FORMAT_SIZE];
+    static char cut[FORMAT_SIZE];
+    int len;
+
+    zassert_equal(latencyFormat(text, sizeof(text)), 0);
+    zassert_equal(text[0], '\0');
+
+    latencyRecord(LATENCY_COAP, 100);
+    latencyRecord(LATENCY_COAP, 300);
+    latencyRecord(LATENCY_UPLINK, 5000);
+
+    len = latencyFormat(text, sizeof(text));
+    zassert_equal(len, strlen(text));
+    zassert_mem_equal(text, "coap n=2 avg=200 p50<=128 p99<=300 max=300\n"
+                            "uplink n=1 avg=5000 p50<=5000 p99<=5000 max=5000\n",
+                      len + 1);
+
+    // Cut in the first and in the second line, the length is the text kept
+    zassert_equal(latencyFormat(cut, 10), 9);
+    zassert_equal(strlen(cut), 9);
+    zassert_mem_equal(cut, text, 9);
+
+    zassert_equal(latencyFormat(cut, len - 5), len - 6);
+    zassert_equal(strlen(cut), len - 6);
+    zassert_mem_equal(cut, text, len - 6);
+
+    zassert_equal(latencyFormat(cut, 1), 0);
+    zassert_equal(cut[0], '\0');
+    zassert_equal(latencyFormat(cut, 0), -EINVAL);
+}
+
+ZTEST_SUITE(latency, NULL, NULL, latencyBefore, NULL, NULL);
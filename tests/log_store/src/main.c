@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Producers of the lock-free log store queue (lmt_log_store.h): the calls do not wait for
+ * the store thread, every line is either stored or counted by logStoreGetDropped(), and
+ * lines of several threads reach the files with none lost or repeated.
+ */
+
+#include "lmt_log_store.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define LOG_DIR            "/lfs"
+#define PRODUCERS          4
+#define PRODUCER_LINES     256
+// Lines a producer writes before it sleeps and lets the store thread drain the queue
+#define PRODUCER_BURST     8
+#define PRODUCER_STACK     2048
+// Above the store thread, a producer is never preempted by it
+#define PRODUCER_PRIORITY  K_PRIO_PREEMPT(5)
+
+typedef struct
+{
+    uint32_t stored;
+    uint32_t dropped;
+} ProducerCounts;
+
+static K_THREAD_STACK_ARRAY_DEFINE(producer_stacks, PRODUCERS, PRODUCER_STACK);
+static struct k_thread producer_threads[PRODUCERS];
+static ProducerCounts producer_counts[PRODUCERS];
+
+/**
+ * @brief Adds the lines of the block heads of one log store file
+ *
+ * @param p_path the file path
+ * @param p_lines pointer to the line count
+ */
+static void countFileLines(const char *p_path, uint32_t *p_lines)
+{
+    LogStoreBlockHead head;
+    struct fs_file_t file;
+
+    fs_file_t_init(&file);
+    zassert_ok(fs_open(&file, p_path, FS_O_READ), "%s", p_path);
+    while(fs_read(&file, &head, sizeof(head)) == sizeof(head))
+    {
+        zassert_equal(head.magic, LOG_STORE_BLOCK_MAGIC, "%s", p_path);
+        *p_lines += head.records;
+        zassert_ok(fs_seek(&file, head.len, FS_SEEK_CUR));
+    }
+    zassert_ok(fs_close(&file));
+}
+
+// Writes the queued lines and counts the lines in all log store files
+static void countStoredLines(uint32_t *p_lines)
+{
+    static struct fs_dirent entry;
+    char path[sizeof(LOG_DIR) + sizeof(entry.name)];
+    struct fs_dir_t dir;
+    size_t name_len;
+
+    zassert_ok(logStoreFlush());
+
+    *p_lines = 0;
+    fs_dir_t_init(&dir);
+    zassert_ok(fs_opendir(&dir, LOG_DIR));
+    while(fs_readdir(&dir, &entry) == 0 && entry.name[0] != '\0')
+    {
+        name_len = strlen(entry.name);
+        // Skips the catalogue and the range scratch file
+        if(name_len <= 8 || strncmp(entry.name, "log_", 4) != 0 ||
+           strcmp(&entry.name[name_len - 4], ".lz4") != 0)
+        {
+            continue;
+        }
+        snprintk(path, sizeof(path), "%s/%s", LOG_DIR, entry.name);
+        countFileLines(path, p_lines);
+    }
+    zassert_ok(fs_closedir(&dir));
+}
+
+static void producerThread(void *p_arg1, void *p_arg2, void *p_arg3)
+{
+    uint32_t index          = POINTER_TO_UINT(p_arg1);
+    ProducerCounts *p_count = &producer_counts[index];
+    int ret;
+
+    ARG_UNUSED(p_arg2);
+    ARG_UNUSED(p_arg3);
+
+    for(uint32_t line = 0; line < PRODUCER_LINES; line++)
+    {
+        ret = logStoreWriteFormatted(LOG_INFORMATIVE, "producer %u line %u", index, line);
+        if(ret == -ENOBUFS)
+        {
+            p_count->dropped++;
+        }
+        else if(ret == 0)
+        {
+            p_count->stored++;
+        }
+
+        // Interleave the claims of the producers
+        k_yield();
+        if((line % PRODUCER_BURST) == (PRODUCER_BURST - 1))
+        {
+            k_msleep(1);
+        }
+    }
+}
+
+ZTEST(log_store, test_full_queue_does_not_wait)
+{
+    uint32_t lines_before;
+    uint32_t dropped_before;
+    uint32_t lines_after;
+    uint32_t stored  = 0;
+    uint32_t dropped = 0;
+    int ret;
+
+    countStoredLines(&lines_before);
+    dropped_before = logStoreGetDropped();
+
+    // The store thread has the lowest priority and can not run during the burst, the
+    // calls past the queue length return at once instead of waiting for it
+    for(int i = 0; i < 4 * LOG_STORE_QUEUE_LENGTH; i++)
+    {
+        ret = logStoreWriteFormatted(LOG_INFORMATIVE, "burst line %d", i);
+        if(ret == -ENOBUFS)
+        {
+            dropped++;
+        }
+        else
+        {
+            zassert_ok(ret);
+            stored++;
+        }
+    }
+
+    zassert_equal(stored, LOG_STORE_QUEUE_LENGTH);
+    zassert_equal(dropped, 3 * LOG_STORE_QUEUE_LENGTH);
+    zassert_equal(logStoreGetDropped() - dropped_before, dropped);
+
+    countStoredLines(&lines_after);
+    zassert_equal(lines_after - lines_before, stored);
+}
+
+ZTEST(log_store, test_producers)
+{
+    uint32_t lines_before;
+    uint32_t dropped_before;
+    uint32_t lines_after;
+    uint32_t stored  = 0;
+    uint32_t dropped = 0;
+
+    countStoredLines(&lines_before);
+    dropped_before = logStoreGetDropped();
+    memset(producer_counts, 0, sizeof(producer_counts));
+
+    for(uint32_t i = 0; i < PRODUCERS; i++)
+    {
+        k_thread_create(&producer_threads[i], producer_stacks[i],
+                        K_THREAD_STACK_SIZEOF(producer_stacks[i]), producerThread,
+                        UINT_TO_POINTER(i), NULL, NULL, PRODUCER_PRIORITY, 0, K_NO_WAIT);
+    }
+    for(uint32_t i = 0; i < PRODUCERS; i++)
+    {
+        zassert_ok(k_thread_join(&producer_threads[i], K_FOREVER));
+        stored  += producer_counts[i].stored;
+        dropped += producer_counts[i].dropped;
+    }
+
+    TC_PRINT("%d producers, %d lines each: %u stored, %u dropped\n", PRODUCERS,
+             PRODUCER_LINES, stored, dropped);
+    zassert_equal(stored + dropped, PRODUCERS * PRODUCER_LINES);
+    zassert_equal(logStoreGetDropped() - dropped_before, dropped);
+
+    countStoredLines(&lines_after);
+    zassert_equal(lines_after - lines_before, stored);
+}
+
+ZTEST_SUITE(log_store, NULL, NULL, NULL, NULL, NULL);
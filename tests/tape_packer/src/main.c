@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Encoder/decoder round trips of the A2 tape packer (lmt_tape_packer.h) and the
+ * encoded bytes per column of the absolute and the zigzag delta Track encoding.
+ */
+
+#include "lmt_tape_packer.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#define TAPE      0
+#define PERIOD    60
+#define SEED      0x2545F491U
+// Tracks of ek_demo: temperature in 0.01 C, BMP390 pressure in Pa, humidity and knob
+#define BMP390_TRACKS 4
+
+static int32_t columns[TAPE_MAX_COLUMNS_COUNT][MAX_TRACKS_COUNT];
+static int32_t decoded[TAPE_MAX_COLUMNS_COUNT][MAX_TRACKS_COUNT];
+static uint8_t encoded[TAPE_PAYLOAD_MAX_SIZE];
+static uint32_t random_state;
+
+static uint32_t nextRandom(void)
+{
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+// Slowly changing sensors: small steps from the previous column
+static void makeColumns(size_t count)
+{
+    static const int32_t base[MAX_TRACKS_COUNT] = {2150, 101325, 4500, 37, -981, 12};
+
+    random_state = SEED;
+    for(size_t i = 0; i < count; i++)
+    {
+        for(int track = 0; track < MAX_TRACKS_COUNT; track++)
+        {
+            int32_t previous = i ? columns[i - 1][track] : base[track];
+
+            columns[i][track] = previous + (int32_t)(nextRandom() % 9) - 4;
+        }
+    }
+}
+
+/**
+ * @brief Adds columns until the uplink is full
+ *
+ * @return number of columns in the Tape
+ */
+static size_t fillTape(void)
+{
+    size_t count = 0;
+    int ret;
+
+    do
+    {
+        ret = tapeAddColumn(TAPE, PERIOD, columns[count]);
+        if(ret >= 0)
+        {
+            count++;
+        }
+    } while(ret > 0 && count < TAPE_MAX_COLUMNS_COUNT);
+
+    return count;
+}
+
+static void encodeTape(size_t *p_len)
+{
+    zassert_ok(tapeEncode(encoded, sizeof(encoded), p_len));
+    zassert_true(*p_len <= TAPE_PAYLOAD_MAX_SIZE);
+}
+
+static void expectRoundTrip(size_t count, uint32_t mask)
+{
+    size_t len;
+
+    encodeTape(&len);
+
+    zassert_equal(tapeDecode(encoded, len, TAPE, &decoded[0][0], TAPE_MAX_COLUMNS_COUNT), count);
+    for(size_t i = 0; i < count; i++)
+    {
+        for(int track = 0; track < MAX_TRACKS_COUNT; track++)
+        {
+            // Tracks outside the mask are not sent and decode as 0
+            int32_t expected = (mask == 0 || (mask & BIT(track))) ? columns[i][track] : 0;
+
+            zassert_equal(decoded[i][track], expected, "column %zu track %d", i, track);
+        }
+    }
+}
+
+static void tapeBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    zassert_ok(tapeSetEncoding(TAPE, TAPE_ABSOLUTE));
+    zassert_ok(tapeSetTrackMask(TAPE, 0));
+    tapeRewind(TAPE);
+    makeColumns(TAPE_MAX_COLUMNS_COUNT);
+}
+
+ZTEST(tape_packer, test_round_trip_absolute)
+{
+    size_t count = fillTape();
+
+    zassert_true(count > 1);
+    expectRoundTrip(count, 0);
+}
+
+ZTEST(tape_packer, test_round_trip_delta)
+{
+    size_t count;
+
+    zassert_ok(tapeSetEncoding(TAPE, TAPE_DELTA_ZIGZAG));
+    // Steps that wrap around int32_t still come back
+    columns[1][0] = INT32_MAX;
+    columns[2][0] = INT32_MIN;
+    columns[3][1] = -1;
+
+    count = fillTape();
+    zassert_true(count > 3);
+    expectRoundTrip(count, 0);
+}
+
+ZTEST(tape_packer, test_decode_other_tape)
+{
+    size_t len;
+
+    zassert_true(fillTape() > 0);
+    encodeTape(&len);
+    zassert_equal(tapeDecode(encoded, len, TAPE_COUNT, &decoded[0][0], TAPE_MAX_COLUMNS_COUNT),
+                  -EINVAL);
+    zassert_equal(tapeDecode(encoded, len / 2, TAPE, &decoded[0][0], TAPE_MAX_COLUMNS_COUNT),
+                  -EBADMSG);
+}
+
+ZTEST(tape_packer, test_delta_bytes_per_column)
+{
+    size_t absolute_count;
+    size_t absolute_len;
+    size_t delta_count;
+    size_t delta_len;
+
+    zassert_ok(tapeSetTrackMask(TAPE, BIT_MASK(BMP390_TRACKS)));
+    absolute_count = fillTape();
+    encodeTape(&absolute_len);
+
+    zassert_ok(tapeSetEncoding(TAPE, TAPE_DELTA_ZIGZAG));
+    delta_count = fillTape();
+    encodeTape(&delta_len);
+    expectRoundTrip(delta_count, BIT_MASK(BMP390_TRACKS));
+
+    TC_PRINT("%d Tracks: absolute %zu columns %zu bytes/column, delta %zu columns %zu "
+             "bytes/column\n",
+             BMP390_TRACKS, absolute_count, absolute_len / absolute_count, delta_count,
+             delta_len / delta_count);
+    // The pressure alone takes 3 varint bytes as is, 1 as a small delta
+    zassert_true(delta_len * absolute_count < absolute_len * delta_count);
+    zassert_true(delta_count >= absolute_count);
+}
+
+ZTEST(tape_packer, test_track_mask_bytes_per_column)
+{
+    static const uint8_t track_counts[] = {1, BMP390_TRACKS, MAX_TRACKS_COUNT};
+    size_t bytes_per_column[ARRAY_SIZE(track_counts)];
+    size_t count;
+    size_t len;
+
+    for(int encoding = TAPE_ABSOLUTE; encoding <= TAPE_DELTA_ZIGZAG; encoding++)
+    {
+        zassert_ok(tapeSetEncoding(TAPE, encoding));
+        for(size_t i = 0; i < ARRAY_SIZE(track_counts); i++)
+        {
+            zassert_ok(tapeSetTrackMask(TAPE, BIT_MASK(track_counts[i])));
+            count = fillTape();
+            encodeTape(&len);
+            expectRoundTrip(count, BIT_MASK(track_counts[i]));
+            bytes_per_column[i] = len / count;
+
+            TC_PRINT("encoding %d, %u Tracks: %zu columns %zu bytes/column\n", encoding,
+                     track_counts[i], count, bytes_per_column[i]);
+            // Tracks outside the mask must not take room in the uplink
+            zassert_true(i == 0 || bytes_per_column[i] > bytes_per_column[i - 1],
+                         "%u Tracks", track_counts[i]);
+        }
+    }
+}
+
+ZTEST(tape_packer, test_round_trip_sparse_mask)
+{
+    uint32_t mask = BIT(1) | BIT(5);
+    size_t count;
+
+    zassert_ok(tapeSetEncoding(TAPE, TAPE_DELTA_ZIGZAG));
+    zassert_ok(tapeSetTrackMask(TAPE, mask));
+    count = fillTape();
+    zassert_true(count > 1);
+    expectRoundTrip(count, mask);
+}
+
+ZTEST_SUITE(tape_packer, NULL, NULL, tapeBefore, NULL, NULL);
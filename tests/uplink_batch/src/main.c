@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Messages per drained uplink of the batching uplink queue (lmt_uplink_queue.h with
+ * CONFIG_LMTSDK_UPLINK_QUEUE_BATCH), counted as the hostShimPack() calls that take the
+ * backlog. Every pack stands for one CoAP exchange of the mailer. The radio-on time and
+ * the RAI release are in the library and not measured here.
+ */
+
+#include "lmt_host_shim.h"
+#include "lmt_uplink_queue.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#define BATCH_MAX        CONFIG_LMTSDK_UPLINK_QUEUE_BATCH_MAX
+#define RECORD_SIZE(len) (UPLINK_QUEUE_RECORD_HEAD_SIZE + (len))
+
+void handleSomEvent(SomEvent event, void *p_data, int i_data)
+{
+    uplinkQueueOnEvent(event, p_data, i_data);
+}
+
+static void queueUplinks(size_t count, size_t len)
+{
+    uint8_t *p_record;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        p_record = uplinkQueueReserve(len);
+        zassert_not_null(p_record, "uplink %zu", i);
+        memset(p_record, (uint8_t)i, len);
+        zassert_ok(uplinkQueueCommit(len));
+    }
+}
+
+/**
+ * @brief Drains the queue and checks every message holds per_message uplinks, the last
+ * one the rest
+ *
+ * @param count queued uplinks of len bytes
+ * @param len uplink length
+ * @param per_message uplinks expected in a full message
+ */
+static void expectDrain(size_t count, size_t len, size_t per_message)
+{
+    size_t left  = count;
+    size_t packs = 0;
+    size_t batch;
+
+    zassert_ok(uplinkQueueSend(false));
+    while(left > 0)
+    {
+        batch = MIN(left, per_message);
+        zassert_equal(hostShimPack(), batch * RECORD_SIZE(len), "message %zu", packs);
+        left -= batch;
+        packs++;
+    }
+    zassert_equal(hostShimPack(), -ENODATA);
+    zassert_equal(uplinkQueueGetCount(), 0);
+
+    TC_PRINT("%zu uplinks of %zu bytes: %zu messages\n", count, len, packs);
+}
+
+static void batchBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    uplinkQueueAbort();
+    uplinkQueueSend(false);
+    while(hostShimPack() >= 0)
+    {
+    }
+}
+
+ZTEST(uplink_batch, test_single_uplink)
+{
+    // A lone uplink is still a batch of one record
+    queueUplinks(1, 10);
+    expectDrain(1, 10, BATCH_MAX);
+}
+
+ZTEST(uplink_batch, test_backlog_by_batch_max)
+{
+    // Small uplinks are limited by CONFIG_LMTSDK_UPLINK_QUEUE_BATCH_MAX
+    queueUplinks(3 * BATCH_MAX + 2, 40);
+    expectDrain(3 * BATCH_MAX + 2, 40, BATCH_MAX);
+}
+
+ZTEST(uplink_batch, test_backlog_by_message_size)
+{
+    // Large uplinks are limited by the message budget
+    size_t per_message = UPLINK_QUEUE_MSG_SIZE / RECORD_SIZE(500);
+    size_t count       = UPLINK_QUEUE_SIZE / RECORD_SIZE(500);
+
+    zassert_true(per_message < BATCH_MAX);
+    queueUplinks(count, 500);
+    expectDrain(count, 500, per_message);
+}
+
+ZTEST(uplink_batch, test_late_uplinks_follow)
+{
+    // Uplinks committed while a batch is in flight go with the next message
+    queueUplinks(2, 40);
+    zassert_ok(uplinkQueueSend(false));
+    queueUplinks(1, 40);
+    zassert_equal(uplinkQueueGetCount(), 3);
+
+    zassert_equal(hostShimPack(), 2 * RECORD_SIZE(40));
+    zassert_equal(hostShimPack(), RECORD_SIZE(40));
+    zassert_equal(hostShimPack(), -ENODATA);
+}
+
+ZTEST_SUITE(uplink_batch, NULL, NULL, batchBefore, NULL, NULL);
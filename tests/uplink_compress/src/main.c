@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Round trips of the LZ4 block compression (lmt_uplink_compress.h) with and
+ * without the preset dictionary, and the rejection of malformed blocks.
+ */
+
+#include "lmt_uplink_compress.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#define TEXT_SIZE 512
+
+// Uplink-like text: the same fields over and over with changing values
+static uint8_t text[TEXT_SIZE];
+static uint8_t dictionary[TEXT_SIZE];
+static uint8_t compressed[TEXT_SIZE * 2];
+static uint8_t restored[TEXT_SIZE];
+
+static size_t fillText(uint8_t *p_out, size_t size, uint32_t seed)
+{
+    size_t len = 0;
+
+    for(uint32_t i = 0; len < size; i++)
+    {
+        char line[48];
+        int line_len = snprintk(line, sizeof(line), "t=%u p=%u rsrp=-%u;", 2150 + (seed + i) % 7,
+                                101325 + (seed * i) % 13, 90 + i % 5);
+
+        line_len = MIN((size_t)line_len, size - len);
+        memcpy(&p_out[len], line, line_len);
+        len += line_len;
+    }
+
+    return len;
+}
+
+static void expectRoundTrip(size_t len)
+{
+    int compressed_len = uplinkCompress(text, len, compressed, sizeof(compressed));
+
+    zassert_true(compressed_len > 0, "compress %d", compressed_len);
+    zassert_equal(uplinkDecompress(compressed, compressed_len, restored, sizeof(restored)), len);
+    zassert_mem_equal(restored, text, len);
+}
+
+static void compressBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    zassert_ok(uplinkCompressSetDictionary(NULL, 0));
+    fillText(text, sizeof(text), 1);
+}
+
+ZTEST(uplink_compress, test_round_trip)
+{
+    static const size_t lengths[] = {1, 12, 13, 64, TEXT_SIZE};
+
+    for(size_t i = 0; i < ARRAY_SIZE(lengths); i++)
+    {
+        expectRoundTrip(lengths[i]);
+    }
+}
+
+ZTEST(uplink_compress, test_repetitive_text_shrinks)
+{
+    int compressed_len = uplinkCompress(text, sizeof(text), compressed, sizeof(compressed));
+
+    zassert_true(compressed_len > 0 && compressed_len < (int)sizeof(text) / 2,
+                 "compressed to %d", compressed_len);
+}
+
+ZTEST(uplink_compress, test_dictionary)
+{
+    int plain_len;
+    int dict_len;
+
+    fillText(dictionary, sizeof(dictionary), 2);
+    // A short uplink has little to match against but the dictionary
+    plain_len = uplinkCompress(text, 64, compressed, sizeof(compressed));
+    zassert_ok(uplinkCompressSetDictionary(dictionary, sizeof(dictionary)));
+    dict_len = uplinkCompress(text, 64, compressed, sizeof(compressed));
+    zassert_true(dict_len > 0 && dict_len < plain_len, "%d with, %d without", dict_len,
+                 plain_len);
+
+    zassert_equal(uplinkDecompress(compressed, dict_len, restored, sizeof(restored)), 64);
+    zassert_mem_equal(restored, text, 64);
+    // The dictionary hashed once gives the same block as hashing it per call
+    zassert_equal(uplinkCompressWithDictionary(dictionary, sizeof(dictionary), text, 64,
+                                               restored, sizeof(restored)),
+                  dict_len);
+    zassert_mem_equal(restored, compressed, dict_len);
+}
+
+ZTEST(uplink_compress, test_dictionary_too_large)
+{
+    zassert_equal(uplinkCompressSetDictionary(dictionary, UPLINK_COMPRESS_MAX_DICT_SIZE + 1),
+                  -EINVAL);
+}
+
+ZTEST(uplink_compress, test_output_full)
+{
+    zassert_equal(uplinkCompress(text, sizeof(text), compressed, 8), -ENOMEM);
+}
+
+ZTEST(uplink_compress, test_malformed_block)
+{
+    // One literal and a match reaching before the start of the data
+    static const uint8_t bad_offset[] = {0x10, 'a', 0x05, 0x00};
+    // Literal run longer than the block
+    static const uint8_t short_literals[] = {0x40, 'a', 'b'};
+    int compressed_len = uplinkCompress(text, sizeof(text), compressed, sizeof(compressed));
+
+    zassert_true(compressed_len > 0);
+    // Decoded data larger than the output
+    zassert_equal(uplinkDecompress(compressed, compressed_len, restored, sizeof(text) - 1),
+                  -EBADMSG);
+    zassert_equal(uplinkDecompress(bad_offset, sizeof(bad_offset), restored, sizeof(restored)),
+                  -EBADMSG);
+    zassert_equal(
+        uplinkDecompress(short_literals, sizeof(short_literals), restored, sizeof(restored)),
+        -EBADMSG);
+}
+
+ZTEST_SUITE(uplink_compress, NULL, NULL, compressBefore, NULL, NULL);
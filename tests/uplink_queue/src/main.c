@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Depth of the raw uplink queue (lmt_uplink_queue.h) for realistic uplink sizes against
+ * fixed slots of the largest uplink, and the FIFO drain through the host shim packer.
+ */
+
+#include "lmt_host_shim.h"
+#include "lmt_uplink_queue.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#define SEED         0x2545F491U
+// Upper bound of the queue depth, an uplink takes at least its head and one byte
+#define MAX_UPLINKS  (UPLINK_QUEUE_SIZE / (UPLINK_QUEUE_RECORD_HEAD_SIZE + 1))
+// Depth of the same RAM in slots of the largest uplink
+#define FIXED_SLOTS  (UPLINK_QUEUE_SIZE / UPLINK_QUEUE_MAX_LEN)
+
+static uint16_t sizes[MAX_UPLINKS];
+static uint32_t random_state;
+
+void handleSomEvent(SomEvent event, void *p_data, int i_data)
+{
+    uplinkQueueOnEvent(event, p_data, i_data);
+}
+
+static uint32_t nextRandom(void)
+{
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return random_state;
+}
+
+/**
+ * @brief Queues uplinks of random sizes in [min, max] until the queue is full
+ *
+ * @param min smallest uplink length
+ * @param max largest uplink length
+ * @param p_count pointer to the number of queued uplinks
+ */
+static void fillQueue(size_t min, size_t max, size_t *p_count)
+{
+    uint8_t *p_record;
+    size_t size;
+
+    random_state = SEED;
+    for(*p_count = 0; *p_count < MAX_UPLINKS; (*p_count)++)
+    {
+        size     = min + nextRandom() % (max - min + 1);
+        p_record = uplinkQueueReserve(size);
+        if(p_record == NULL)
+        {
+            break;
+        }
+        memset(p_record, (uint8_t)*p_count, size);
+        zassert_ok(uplinkQueueCommit(size));
+        sizes[*p_count] = size;
+    }
+    zassert_equal(uplinkQueueGetCount(), *p_count);
+}
+
+// Hands the uplinks over one by one and checks they come out in order
+static void expectDrain(size_t count)
+{
+    zassert_ok(uplinkQueueSend(false));
+    for(size_t i = 0; i < count; i++)
+    {
+        zassert_equal(hostShimPack(), sizes[i], "uplink %zu", i);
+    }
+    zassert_equal(hostShimPack(), -ENODATA);
+    zassert_equal(uplinkQueueGetCount(), 0);
+}
+
+/**
+ * @brief Fills the queue with one size distribution, reports the depth against the
+ * fixed slots and drains it
+ *
+ * @param p_name distribution name for the report
+ * @param min smallest uplink length
+ * @param max largest uplink length
+ * @param min_depth least queue depth expected
+ */
+static void expectDepth(const char *p_name, size_t min, size_t max, size_t min_depth)
+{
+    size_t count;
+
+    fillQueue(min, max, &count);
+    TC_PRINT("%-8s %4zu..%4zu bytes: %3zu uplinks queued, %d fixed slots\n", p_name, min, max,
+             count, FIXED_SLOTS);
+    zassert_true(count >= min_depth, "%s: %zu uplinks", p_name, count);
+    expectDrain(count);
+}
+
+static void queueBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    uplinkQueueAbort();
+    uplinkQueueSend(false);
+    while(hostShimPack() >= 0)
+    {
+    }
+}
+
+ZTEST(uplink_queue, test_depth_sensor_readings)
+{
+    // A few Tracks of one or two columns, the ek_demo uplink
+    expectDepth("sensor", 24, 64, 20 * FIXED_SLOTS);
+}
+
+ZTEST(uplink_queue, test_depth_mixed)
+{
+    // Readings and Tape uplinks of a few dozen columns
+    expectDepth("mixed", 24, 400, 5 * FIXED_SLOTS);
+}
+
+ZTEST(uplink_queue, test_depth_largest)
+{
+    // The worst case is no deeper than the fixed slots
+    expectDepth("largest", UPLINK_QUEUE_MAX_LEN, UPLINK_QUEUE_MAX_LEN, FIXED_SLOTS);
+}
+
+ZTEST(uplink_queue, test_wrap_keeps_order)
+{
+    size_t count;
+
+    // Ten records leave less than one at the ring end
+    fillQueue(400, 400, &count);
+    zassert_equal(count, UPLINK_QUEUE_SIZE / (UPLINK_QUEUE_RECORD_HEAD_SIZE + 400));
+
+    // Packing the oldest frees the ring start, the next uplink wraps around the end
+    zassert_ok(uplinkQueueSend(false));
+    zassert_equal(hostShimPack(), 400);
+    zassert_not_null(uplinkQueueReserve(300));
+    zassert_ok(uplinkQueueCommit(300));
+    sizes[count] = 300;
+
+    for(size_t i = 1; i <= count; i++)
+    {
+        zassert_equal(hostShimPack(), sizes[i], "uplink %zu", i);
+    }
+    zassert_equal(uplinkQueueGetCount(), 0);
+}
+
+ZTEST_SUITE(uplink_queue, NULL, NULL, queueBefore, NULL, NULL);
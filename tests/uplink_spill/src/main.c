@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 LMT
+ *
+ * Power cut recovery of the uplink journal (lmt_uplink_spill.h) on the flash simulator.
+ * A power cut is played by damaging the files the way a torn write leaves them and then
+ * forgetting the RAM state with uplinkSpillTestReboot().
+ */
+
+#include "lmt_filesystem.h"
+#include "lmt_uplink_spill.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/ztest.h>
+
+#define JOURNAL_PATH    "/lfs/uplink.jnl"
+// Position copies, the one of an odd write count is uplink.pb
+#define POSITION_EVEN   "uplink.pa"
+#define POSITION_ODD    "uplink.pb"
+// Journal head, record head and payload
+#define RECORD_LEN      56
+#define RECORD_SIZE     (8 + RECORD_LEN)
+#define JOURNAL_RECORDS ((CONFIG_LMTSDK_UPLINK_SPILL_MAX_SIZE - 8) / RECORD_SIZE)
+
+static uint8_t record[RECORD_LEN];
+static uint8_t buffer[RECORD_LEN * 2];
+
+static void fillRecord(uint32_t index)
+{
+    for(size_t i = 0; i < sizeof(record); i++)
+    {
+        record[i] = (uint8_t)(index * 31 + i);
+    }
+}
+
+static void appendRecords(uint32_t first, uint32_t count)
+{
+    for(uint32_t i = first; i < first + count; i++)
+    {
+        fillRecord(i);
+        zassert_ok(uplinkSpillAppend(record, sizeof(record)), "append %u", i);
+    }
+}
+
+static void popRecords(uint32_t count)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        zassert_ok(uplinkSpillPop());
+    }
+}
+
+// Drains the journal and checks the records come out in order from first on
+static void expectRecords(uint32_t first, uint32_t count)
+{
+    zassert_equal(uplinkSpillGetCount(), count);
+    for(uint32_t i = first; i < first + count; i++)
+    {
+        fillRecord(i);
+        zassert_equal(uplinkSpillPeek(buffer, sizeof(buffer)), sizeof(record), "peek %u", i);
+        zassert_mem_equal(buffer, record, sizeof(record), "record %u", i);
+        zassert_ok(uplinkSpillPop());
+    }
+    zassert_equal(uplinkSpillPeek(buffer, sizeof(buffer)), -ENODATA);
+}
+
+static void appendRaw(const void *p_data, size_t len)
+{
+    struct fs_file_t file;
+
+    fs_file_t_init(&file);
+    zassert_ok(fs_open(&file, JOURNAL_PATH, FS_O_WRITE | FS_O_APPEND));
+    zassert_equal(fs_write(&file, p_data, len), len);
+    zassert_ok(fs_close(&file));
+}
+
+static void spillBefore(void *p_fixture)
+{
+    ARG_UNUSED(p_fixture);
+
+    while(uplinkSpillPop() == 0)
+    {
+    }
+    uplinkSpillTestReboot();
+}
+
+ZTEST(uplink_spill, test_fifo_across_reboot)
+{
+    appendRecords(0, 5);
+    popRecords(2);
+
+    uplinkSpillTestReboot();
+    expectRecords(2, 3);
+}
+
+ZTEST(uplink_spill, test_torn_append)
+{
+    // Head of a record whose payload never made it to flash
+    static const uint8_t torn[] = {0x55, 0x4A, RECORD_LEN, 0x00, 0x12, 0x34};
+
+    appendRecords(0, 3);
+    popRecords(1);
+    appendRaw(torn, sizeof(torn));
+
+    uplinkSpillTestReboot();
+    zassert_equal(uplinkSpillGetCount(), 2);
+    zassert_equal(getFileSize("uplink.jnl"), 8 + 3 * RECORD_SIZE, "torn tail not cut");
+
+    appendRecords(3, 1);
+    expectRecords(1, 3);
+}
+
+ZTEST(uplink_spill, test_torn_position)
+{
+    appendRecords(0, 4);
+    // Positions 1 and 2 are written, 2 to the even copy
+    popRecords(2);
+    zassert_true(fileOverwrite(POSITION_EVEN, "2 1 7") > 0);
+
+    // The previous copy repeats one uplink, nothing is lost
+    uplinkSpillTestReboot();
+    expectRecords(1, 3);
+}
+
+ZTEST(uplink_spill, test_damaged_position)
+{
+    appendRecords(0, 4);
+    popRecords(2);
+    // Complete text, but an offset in the middle of a record and no matching CRC
+    zassert_true(fileOverwrite(POSITION_EVEN, "2 1 40 12345") > 0);
+
+    uplinkSpillTestReboot();
+    expectRecords(1, 3);
+}
+
+ZTEST(uplink_spill, test_compaction)
+{
+    appendRecords(0, JOURNAL_RECORDS);
+    zassert_equal(uplinkSpillAppend(record, sizeof(record)), -ENOSPC);
+
+    // Drained records make room again
+    popRecords(5);
+    appendRecords(JOURNAL_RECORDS, 5);
+    zassert_true(getFileSize("uplink.jnl") <= CONFIG_LMTSDK_UPLINK_SPILL_MAX_SIZE);
+
+    uplinkSpillTestReboot();
+    expectRecords(5, JOURNAL_RECORDS);
+}
+
+ZTEST(uplink_spill, test_power_cut_after_compaction)
+{
+    appendRecords(0, JOURNAL_RECORDS);
+    popRecords(5);
+    // Compacts and writes position 6 of the new generation to the even copy
+    appendRecords(JOURNAL_RECORDS, 1);
+
+    // Cut between the rename and the position write: only the odd copy of the old
+    // generation is left, its offset must not be applied to the new journal
+    zassert_ok(deleteFile(POSITION_EVEN));
+
+    uplinkSpillTestReboot();
+    expectRecords(5, JOURNAL_RECORDS - 4);
+}
+
+ZTEST(uplink_spill, test_power_cut_during_compaction)
+{
+    appendRecords(0, 4);
+    popRecords(1);
+    // Copy of a compaction that never got renamed
+    zassert_true(fileOverwrite("uplink.tmp", "partial") > 0);
+
+    uplinkSpillTestReboot();
+    expectRecords(1, 3);
+    zassert_true(getFileSize("uplink.tmp") < 0, "stale copy not deleted");
+}
+
+ZTEST_SUITE(uplink_spill, NULL, NULL, spillBefore, NULL, NULL);